@@ -0,0 +1,115 @@
+// bench.h
+// Shared helpers for the MCLI host benchmarks
+#pragma once
+
+#include <pthread.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "mcli.h"
+#include "mcli_memory_loopback.h"
+
+namespace bench {
+
+    // Context shared by every benchmark command table
+    struct Context {
+        uint32_t calls;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Keep the optimizer from discarding a computed value
+    template<typename T>
+    inline void keep(const T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * Run fn(iterations) with iterations doubled until it takes at least
+     * min_seconds, then report the per-iteration time in nanoseconds.
+     */
+    template<typename Fn>
+    double time_per_op_ns(Fn fn, double min_seconds = 0.2) {
+        size_t iterations = 1;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            fn(iterations);
+            double elapsed = seconds_since(start);
+            if (elapsed >= min_seconds || iterations >= (size_t(1) << 34)) {
+                return elapsed * 1e9 / static_cast<double>(iterations);
+            }
+            iterations *= 2;
+        }
+    }
+
+    namespace detail {
+        struct StackRun {
+            void (*fn)(const void*);
+            const void* arg;
+        };
+
+        inline void* run_on_stack(void* run) {
+            StackRun* r = static_cast<StackRun*>(run);
+            if (r->fn) {
+                r->fn(r->arg);
+            }
+            return nullptr;
+        }
+
+        // Bytes of a painted thread stack that fn(arg) touched
+        inline size_t painted_stack_used(void (*fn)(const void*), const void* arg) {
+            const size_t stack_size = 256 * 1024;
+            const unsigned char paint = 0xA5;
+            std::vector<unsigned char> stack(stack_size);
+            memset(stack.data(), paint, stack.size());
+
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            pthread_attr_setstack(&attr, stack.data(), stack.size());
+
+            StackRun run = {fn, arg};
+            pthread_t thread;
+            if (pthread_create(&thread, &attr, run_on_stack, &run) != 0) {
+                pthread_attr_destroy(&attr);
+                return 0;
+            }
+            pthread_join(thread, nullptr);
+            pthread_attr_destroy(&attr);
+
+            // The stack grows down, so untouched paint is at the low end
+            size_t untouched = 0;
+            while (untouched < stack.size() && stack[untouched] == paint) {
+                untouched++;
+            }
+            return stack.size() - untouched;
+        }
+    }
+
+    /**
+     * Stack high-water mark of fn(arg): run it on a painted thread stack and
+     * count the bytes it touched beyond what an empty thread uses
+     */
+    inline size_t stack_used(void (*fn)(const void*), const void* arg) {
+        size_t baseline = detail::painted_stack_used(nullptr, nullptr);
+        size_t used = detail::painted_stack_used(fn, arg);
+        return used > baseline ? used - baseline : 0;
+    }
+
+    inline void section(const char* title) {
+        printf("\n== %s ==\n", title);
+    }
+
+    // Suites, one per translation unit
+    void run_dispatch(double min_seconds);
+    void run_stack();
+
+}
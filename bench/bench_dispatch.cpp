@@ -0,0 +1,81 @@
+// bench_dispatch.cpp
+// Command lookup cost as the table grows, sorted (binary search) vs unsorted (linear scan)
+
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+#include "bench.h"
+
+namespace {
+
+    using Engine = mcli::CliEngine<bench::Context>;
+    using Command = Engine::CommandType;
+
+    void count_call(const mcli::CommandArgsView&, bench::Context* ctx) {
+        ctx->calls++;
+    }
+
+    // N generated commands "c0000".."cN-1", in ascending or descending order
+    template<size_t N>
+    struct GeneratedTable {
+        char names[N][8];
+        Command entries[N];
+
+        explicit GeneratedTable(bool sorted)
+            : GeneratedTable(sorted, std::make_index_sequence<N>()) {}
+
+        template<size_t... I>
+        GeneratedTable(bool sorted, std::index_sequence<I...>)
+            : names(), entries{ {name(sorted, I), count_call, ""}... } {}
+
+        const char* name(bool sorted, size_t i) {
+            snprintf(names[i], sizeof(names[i]), "c%04u", static_cast<unsigned>(sorted ? i : N - 1 - i));
+            return names[i];
+        }
+    };
+
+    template<size_t N>
+    void run_table(double min_seconds) {
+        // Every command gets looked up in turn, so this is the average cost
+        static char lines[N][16];
+        for (size_t i = 0; i < N; i++) {
+            snprintf(lines[i], sizeof(lines[i]), "c%04u 1 2", static_cast<unsigned>(i));
+        }
+
+        for (int sorted = 1; sorted >= 0; sorted--) {
+            std::unique_ptr<GeneratedTable<N>> table(new GeneratedTable<N>(sorted != 0));
+
+            MemoryLoopbackIo<0> io;
+            bench::Context ctx = {0};
+            Engine cli(io, ctx, table->entries);
+
+            double ns = bench::time_per_op_ns([&](size_t iterations) {
+                size_t next = 0;
+                for (size_t n = 0; n < iterations; n++) {
+                    cli.execute_command(lines[next]);
+                    if (++next == N) next = 0;
+                }
+            }, min_seconds);
+
+            if (ctx.calls == 0) {
+                printf("  (no commands matched)\n");
+            }
+            printf("  %5u commands, %-9s %7.1f ns/command\n",
+                   static_cast<unsigned>(N), sorted ? "sorted" : "unsorted", ns);
+        }
+    }
+
+}
+
+namespace bench {
+
+    // execute_command(): copy, tokenize and dispatch one line
+    void run_dispatch(double min_seconds) {
+        section("execute_command vs table size");
+        run_table<10>(min_seconds);
+        run_table<100>(min_seconds);
+        run_table<1000>(min_seconds);
+    }
+
+}
@@ -0,0 +1,154 @@
+// bench_main.cpp
+// MCLI host benchmarks: input throughput, tokenizer and printf cost
+//
+//   cmake -S . -B build && cmake --build build
+//   ./build/bench/mcli_bench [min-seconds-per-measurement]
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench.h"
+
+namespace {
+
+    void set_value(const mcli::CommandArgsView& args, bench::Context* ctx) {
+        ctx->calls += static_cast<uint32_t>(args.argc);
+    }
+
+    const mcli::CommandDefinition<bench::Context> commands[] = {
+        {"get", set_value, "Read a value"},
+        {"set", set_value, "Write a value"},
+    };
+
+    // Lines per second through process_input(), with echo (interactive) or without (batch)
+    template<typename Engine, typename Io>
+    void run_throughput_flavor(const char* flavor, const std::string& script, int lines, double min_seconds) {
+        for (int batch = 0; batch < 2; batch++) {
+            Io io;
+            bench::Context ctx = {0};
+            Engine cli(io, ctx, commands);
+            cli.set_batch_mode(batch != 0);
+
+            double ns = bench::time_per_op_ns([&](size_t iterations) {
+                for (size_t n = 0; n < iterations; n++) {
+                    io.set_input(script.data(), script.size());
+                    while (io.input_remaining() > 0) {
+                        cli.process_input();
+                    }
+                }
+            }, min_seconds);
+
+            double per_line = ns / lines;
+            printf("  %-12s %-8s %8.1f ns/line  %10.0f lines/s  %7.1f MB/s in\n",
+                   batch ? "batch" : "interactive", flavor, per_line, 1e9 / per_line,
+                   script.size() / (ns * 1e-9) / 1e6);
+        }
+    }
+
+    void run_throughput(double min_seconds) {
+        bench::section("process_input throughput");
+
+        const int lines = 1000;
+        std::string script;
+        for (int i = 0; i < lines; i++) {
+            script += "set 0x40 ";
+            script += std::to_string(i);
+            script += "\r\n";
+        }
+
+        // CliEngine goes through the CliIoInterface vtable; BasicCliEngine calls the adapter directly
+        using Io = MemoryLoopbackIo<0>;
+        run_throughput_flavor<mcli::CliEngine<bench::Context>, Io>("virtual", script, lines, min_seconds);
+        run_throughput_flavor<mcli::BasicCliEngine<Io, bench::Context>, Io>("direct", script, lines, min_seconds);
+    }
+
+    // Tokenizer cost (what parse_command_line() does) by argument count
+    void run_tokenizer(double min_seconds) {
+        bench::section("tokenize_in_place");
+
+        const char* samples[] = {
+            "status",
+            "led 2 on",
+            "i2c write 0x40 0x01 0xff",
+            "   spaced    out     tokens  here  ",
+        };
+
+        for (const char* sample : samples) {
+            char line[mcli::CMD_BUFFER_SIZE];
+            const char* argv[mcli::MAX_ARGS + 1];
+            size_t lengths[mcli::MAX_ARGS];
+            size_t len = strlen(sample);
+
+            double ns = bench::time_per_op_ns([&](size_t iterations) {
+                for (size_t n = 0; n < iterations; n++) {
+                    memcpy(line, sample, len + 1);
+                    int argc = mcli::tokenize_in_place(line, argv, lengths, mcli::MAX_ARGS);
+                    bench::keep(argc);
+                }
+            }, min_seconds);
+
+            printf("  %-40s %7.1f ns\n", sample, ns);
+        }
+    }
+
+    // Formatter throughput into a discarding sink
+    void run_printf(double min_seconds) {
+        bench::section("printf");
+
+        MemoryLoopbackIo<0> io;
+
+        struct Case {
+            const char* label;
+            void (*emit)(mcli::CliIoInterface& io, unsigned n);
+        };
+        const Case cases[] = {
+            {"plain string", [](mcli::CliIoInterface& io, unsigned) {
+                io.printf("Available commands:\r\n");
+            }},
+            {"padded %-*s table row", [](mcli::CliIoInterface& io, unsigned n) {
+                io.printf("  %-*s -- %s\r\n", 12, "status", n & 1 ? "Show status" : "Print state");
+            }},
+            {"integers %d %u %08x", [](mcli::CliIoInterface& io, unsigned n) {
+                io.printf("%d %u 0x%08x\r\n", -static_cast<int>(n), n, n);
+            }},
+            {"float %.3f", [](mcli::CliIoInterface& io, unsigned n) {
+                io.printf("%.3f\r\n", n * 0.125);
+            }},
+        };
+
+        for (const Case& c : cases) {
+            io.clear_output();
+            size_t calls = 0;
+            double ns = bench::time_per_op_ns([&](size_t iterations) {
+                for (size_t n = 0; n < iterations; n++) {
+                    c.emit(io, static_cast<unsigned>(n));
+                }
+                calls += iterations;
+            }, min_seconds);
+
+            double bytes_per_call = static_cast<double>(io.output_total()) / calls;
+            printf("  %-26s %7.1f ns/call  %7.1f MB/s\n", c.label, ns,
+                   bytes_per_call / (ns * 1e-9) / 1e6);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    double min_seconds = (argc > 1) ? atof(argv[1]) : 0.2;
+    if (min_seconds <= 0) min_seconds = 0.2;
+
+#ifdef MCLI_ENABLE_STATS
+    printf("mcli benchmarks (MCLI_ENABLE_STATS on)\n");
+#else
+    printf("mcli benchmarks\n");
+#endif
+
+    run_throughput(min_seconds);
+    run_tokenizer(min_seconds);
+    bench::run_dispatch(min_seconds);
+    run_printf(min_seconds);
+    bench::run_stack();
+    return 0;
+}
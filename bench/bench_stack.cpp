@@ -0,0 +1,83 @@
+// bench_stack.cpp
+// Stack high-water marks: run a scenario on a painted thread stack and see how much was touched
+
+#include <cstdio>
+
+#include "bench.h"
+
+namespace {
+
+    struct PrintContext : bench::Context {
+        mcli::CliIoInterface* io;
+    };
+
+    void report(const mcli::CommandArgsView& args, PrintContext* ctx) {
+        ctx->io->printf("%-*s %8u 0x%08x %.2f\r\n", 10, args[0], ctx->calls, ctx->calls, ctx->calls * 0.5);
+        ctx->calls++;
+    }
+
+    void legacy(const mcli::CommandArgs args, PrintContext* ctx) {
+        ctx->io->printf("%d args\r\n", args.argc);
+    }
+
+    void typed(PrintContext* ctx, unsigned id, bool on, float level) {
+        ctx->io->printf("%u %d %f\r\n", id, on, level);
+    }
+
+    const mcli::CommandDefinition<PrintContext> group_commands[] = {
+        {"report", report, "Formatted output"},
+    };
+
+    const mcli::CommandDefinition<PrintContext> commands[] = {
+        {"grp", group_commands, "Group"},
+        {"led", MCLI_TYPED(typed), "Typed arguments"},
+        {"legacy", legacy, "Copied arguments"},
+        {"report", report, "Formatted output"},
+    };
+
+    struct Scenario {
+        const char* label;
+        const char* input; // nullptr: construct the engine only
+    };
+
+    void run_scenario(const void* arg) {
+        const Scenario* scenario = static_cast<const Scenario*>(arg);
+
+        MemoryLoopbackIo<0> io;
+        PrintContext ctx;
+        ctx.calls = 0;
+        ctx.io = &io;
+        mcli::CliEngine<PrintContext> cli(io, ctx, commands);
+        if (scenario->input) {
+            io.set_input(scenario->input);
+            while (io.input_remaining() > 0) {
+                cli.process_input();
+            }
+        }
+        cli.process_input();
+    }
+
+}
+
+namespace bench {
+
+    void run_stack() {
+        section("stack high-water (above an empty thread)");
+
+        const Scenario scenarios[] = {
+            {"engine + prompt", nullptr},
+            {"view handler + printf", "report\r"},
+            {"legacy CommandArgs", "legacy a b c\r"},
+            {"typed arguments", "led 3 on 0.5\r"},
+            {"group dispatch", "grp report\r"},
+            {"help", "help\r"},
+            {"unknown command", "nope\r"},
+        };
+
+        for (const Scenario& scenario : scenarios) {
+            size_t used = bench::stack_used(run_scenario, &scenario);
+            printf("  %-24s %6u bytes\n", scenario.label, static_cast<unsigned>(used));
+        }
+    }
+
+}
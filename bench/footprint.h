@@ -0,0 +1,19 @@
+// footprint.h
+// Entry points of one footprint configuration (footprint_config.cpp), called by the runner
+#pragma once
+
+namespace footprint {
+
+    extern const char* const config_name;
+
+    void setup();
+
+    // Feed line to the first session and process_input() until it is consumed
+    void run_line(const char* line);
+
+    void print_help();
+
+    // A typical handler's formatted output through the session's adapter
+    void print_formatted();
+
+}
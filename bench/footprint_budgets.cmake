@@ -0,0 +1,33 @@
+# footprint_budgets.cmake
+# Budgets checked by the mcli_footprint target, in bytes (host x86-64 -Os numbers)
+# with roughly 20% headroom. Point MCLI_FOOTPRINT_BUDGETS at a copy for a target toolchain.
+
+set(MCLI_BUDGET_minimal_TEXT 17500)
+set(MCLI_BUDGET_minimal_DATA 700)
+set(MCLI_BUDGET_minimal_BSS 580)
+set(MCLI_BUDGET_minimal_STACK 4600)
+
+set(MCLI_BUDGET_default_TEXT 17500)
+set(MCLI_BUDGET_default_DATA 700)
+set(MCLI_BUDGET_default_BSS 740)
+set(MCLI_BUDGET_default_STACK 4600)
+
+set(MCLI_BUDGET_history_TEXT 18200)
+set(MCLI_BUDGET_history_DATA 700)
+set(MCLI_BUDGET_history_BSS 1080)
+set(MCLI_BUDGET_history_STACK 4600)
+
+set(MCLI_BUDGET_direct_TEXT 17000)
+set(MCLI_BUDGET_direct_DATA 700)
+set(MCLI_BUDGET_direct_BSS 740)
+set(MCLI_BUDGET_direct_STACK 4600)
+
+set(MCLI_BUDGET_stats_TEXT 25000)
+set(MCLI_BUDGET_stats_DATA 700)
+set(MCLI_BUDGET_stats_BSS 1130)
+set(MCLI_BUDGET_stats_STACK 4700)
+
+set(MCLI_BUDGET_multi_TEXT 17500)
+set(MCLI_BUDGET_multi_DATA 700)
+set(MCLI_BUDGET_multi_BSS 2250)
+set(MCLI_BUDGET_multi_STACK 4600)
@@ -0,0 +1,137 @@
+// footprint_config.cpp
+// One engine configuration for the footprint report. The build compiles this file
+// once per configuration and measures each copy's .text/.data/.bss:
+//
+//   MCLI_FP_MINIMAL   64-byte line, 4 arguments, no history (ATmega-class)
+//   MCLI_FP_HISTORY   defaults plus a 256-byte history ring
+//   MCLI_FP_DIRECT    defaults on the devirtualized BasicCliEngine
+//   MCLI_FP_MULTI     three sessions on one shared dispatcher
+//   (none)            defaults; with MCLI_ENABLE_STATS this is the stats configuration
+//
+// TAB completion and line editing are part of every configuration.
+
+#include <cstdlib>
+
+#include "footprint.h"
+
+#include "mcli.h"
+#include "mcli_memory_loopback.h"
+
+namespace {
+
+    using Io = MemoryLoopbackIo<0>;
+
+    struct AppContext {
+        mcli::CliIoInterface* io;
+        uint32_t value;
+    };
+
+#if defined(MCLI_FP_MINIMAL)
+    using Engine = mcli::CliEngine<AppContext, 64, 4, 12>;
+    const char* const name = "minimal";
+#elif defined(MCLI_FP_HISTORY)
+    using Engine = mcli::CliEngine<AppContext, mcli::CMD_BUFFER_SIZE, mcli::MAX_ARGS, mcli::MAX_ARG_LENGTH, 256>;
+    const char* const name = "history";
+#elif defined(MCLI_FP_DIRECT)
+    using Engine = mcli::BasicCliEngine<Io, AppContext>;
+    const char* const name = "direct";
+#elif defined(MCLI_FP_MULTI)
+    using Engine = mcli::CliEngine<AppContext>;
+    const char* const name = "multi";
+#elif defined(MCLI_ENABLE_STATS)
+    using Engine = mcli::CliEngine<AppContext>;
+    const char* const name = "stats";
+#else
+    using Engine = mcli::CliEngine<AppContext>;
+    const char* const name = "default";
+#endif
+
+#if defined(MCLI_FP_MULTI)
+    const int SESSIONS = 3;
+#else
+    const int SESSIONS = 1;
+#endif
+
+    void status(const mcli::CommandArgsView& args, AppContext* ctx) {
+        ctx->io->printf("%s: value=%lu (0x%08lx)\r\n", args[0], (unsigned long)ctx->value, (unsigned long)ctx->value);
+    }
+
+    void set_value(AppContext* ctx, unsigned value, bool persist) {
+        ctx->value = value;
+        ctx->io->printf("set %u%s\r\n", value, persist ? " (saved)" : "");
+    }
+
+    void reboot(const Engine::ArgsType args, AppContext* ctx) {
+        ctx->io->printf("reboot in %d\r\n", args.argc > 1 ? atoi(args.argv[1]) : 0);
+    }
+
+    const Engine::CommandType net_commands[] = {
+        {"info", status, "Show link state"},
+        {"mtu", MCLI_TYPED(set_value), "Set the MTU"},
+    };
+
+    const Engine::CommandType commands[] = {
+        {"net", net_commands, "Network commands"},
+        {"reboot", reboot, "Restart after a delay"},
+        {"set", MCLI_TYPED(set_value), "Set the value"},
+        {"status", status, "Show the value"},
+    };
+
+#if defined(MCLI_FP_MULTI)
+    const Engine::DispatcherType dispatcher(commands);
+
+    struct Session {
+        Io io;
+        AppContext ctx;
+        Engine cli;
+
+        Session() : ctx{&io, 0}, cli(io, ctx, dispatcher, "> ") {}
+    };
+#else
+    struct Session {
+        Io io;
+        AppContext ctx;
+        Engine cli;
+
+        Session() : ctx{&io, 0}, cli(io, ctx, commands, "> ") {}
+    };
+#endif
+
+    Session sessions[SESSIONS];
+
+#ifdef MCLI_ENABLE_STATS
+    mcli::CommandStats stats[8];
+#endif
+
+}
+
+namespace footprint {
+
+    const char* const config_name = name;
+
+    void setup() {
+#ifdef MCLI_ENABLE_STATS
+        sessions[0].cli.set_stats_storage(stats);
+#endif
+        for (Session& session : sessions) {
+            session.cli.process_input();
+        }
+    }
+
+    void run_line(const char* line) {
+        Session& session = sessions[0];
+        session.io.set_input(line);
+        while (session.io.input_remaining() > 0) {
+            session.cli.process_input();
+        }
+    }
+
+    void print_help() {
+        sessions[0].cli.print_help();
+    }
+
+    void print_formatted() {
+        sessions[0].io.printf("  %-*s %8u 0x%08x %.2f\r\n", 10, "status", 42u, 42u, 0.5);
+    }
+
+}
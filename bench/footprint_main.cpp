@@ -0,0 +1,61 @@
+// footprint_main.cpp
+// Stack high-water per engine entry point for one footprint configuration.
+// Prints "stack <entry point> <bytes>" lines for footprint_report.cmake.
+
+#include <cstdio>
+
+#include "bench.h"
+#include "footprint.h"
+
+namespace {
+
+    // Lines exercising each command kind; process_input() is reported as the worst of them
+    const char* const lines[] = {
+        "status\r",
+        "set 42 on\r",
+        "set nope\r",
+        "reboot 5\r",
+        "net info\r",
+        "net mtu 1500 off\r",
+        "net bogus\r",
+        "unknown\r",
+        "stat\t\r",
+    };
+
+    void run_line(const void* line) {
+        footprint::setup();
+        footprint::run_line(static_cast<const char*>(line));
+    }
+
+    void run_help(const void*) {
+        footprint::setup();
+        footprint::print_help();
+    }
+
+    void run_printf(const void*) {
+        footprint::setup();
+        footprint::print_formatted();
+    }
+
+    void run_setup(const void*) {
+        footprint::setup();
+    }
+
+}
+
+int main() {
+    size_t setup = bench::stack_used(run_setup, nullptr);
+
+    size_t process = 0;
+    for (const char* line : lines) {
+        size_t used = bench::stack_used(run_line, line);
+        if (used > process) process = used;
+    }
+
+    printf("config %s\n", footprint::config_name);
+    printf("stack process_input %u\n", static_cast<unsigned>(process));
+    printf("stack print_help %u\n", static_cast<unsigned>(bench::stack_used(run_help, nullptr)));
+    printf("stack printf %u\n", static_cast<unsigned>(bench::stack_used(run_printf, nullptr)));
+    printf("stack setup %u\n", static_cast<unsigned>(setup));
+    return 0;
+}
@@ -0,0 +1,113 @@
+# footprint_report.cmake
+# Run by the mcli_footprint target: size each configuration's object, run its stack
+# probe, print a table and fail when a budget from BUDGETS is exceeded.
+#
+#   -DSIZE_TOOL=<size>  -DCONFIGS=a,b,...  -DBUDGETS=<file>
+#   -DLIB_<config>=<archive>  [-DRUN_<config>=<stack probe>]
+#
+# Budgets are MCLI_BUDGET_<config>_{TEXT,DATA,BSS,STACK} in bytes; unset means unchecked.
+
+if(NOT SIZE_TOOL)
+    message(FATAL_ERROR "footprint: no size tool found (set MCLI_SIZE_TOOL)")
+endif()
+
+if(BUDGETS AND EXISTS "${BUDGETS}")
+    include("${BUDGETS}")
+endif()
+
+string(REPLACE "," ";" configs "${CONFIGS}")
+set(failures)
+
+function(mcli_pad out value width)
+    string(LENGTH "${value}" len)
+    set(padded "${value}")
+    while(len LESS width)
+        set(padded " ${padded}")
+        math(EXPR len "${len} + 1")
+    endwhile()
+    set(${out} "${padded}" PARENT_SCOPE)
+endfunction()
+
+# Compare value against MCLI_BUDGET_<config>_<what> and append to failures when over;
+# an extra argument names what was measured (the entry point for STACK)
+macro(mcli_check config what value)
+    set(budget "${MCLI_BUDGET_${config}_${what}}")
+    set(label "${what}")
+    if(NOT "${ARGN}" STREQUAL "")
+        set(label "${what} ${ARGN}")
+    endif()
+    if(NOT "${budget}" STREQUAL "" AND NOT "${value}" STREQUAL "-")
+        if(${value} GREATER ${budget})
+            list(APPEND failures "${config} ${label} ${value} > budget ${budget}")
+        endif()
+    endif()
+endmacro()
+
+message(STATUS "")
+message(STATUS "config      .text   .data    .bss   process_input  print_help  printf   (bytes)")
+
+foreach(config IN LISTS configs)
+    # Berkeley format, one row per archive member: text data bss dec hex filename
+    execute_process(COMMAND "${SIZE_TOOL}" "${LIB_${config}}"
+        OUTPUT_VARIABLE size_out RESULT_VARIABLE size_rc)
+    if(NOT size_rc EQUAL 0)
+        message(FATAL_ERROR "footprint: ${SIZE_TOOL} failed on ${LIB_${config}}")
+    endif()
+
+    set(text 0)
+    set(data 0)
+    set(bss 0)
+    string(REPLACE "\n" ";" size_lines "${size_out}")
+    foreach(line IN LISTS size_lines)
+        if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]")
+            math(EXPR text "${text} + ${CMAKE_MATCH_1}")
+            math(EXPR data "${data} + ${CMAKE_MATCH_2}")
+            math(EXPR bss "${bss} + ${CMAKE_MATCH_3}")
+        endif()
+    endforeach()
+
+    set(stack_process_input "-")
+    set(stack_print_help "-")
+    set(stack_printf "-")
+    if(RUN_${config})
+        execute_process(COMMAND "${RUN_${config}}"
+            OUTPUT_VARIABLE run_out RESULT_VARIABLE run_rc)
+        if(NOT run_rc EQUAL 0)
+            message(FATAL_ERROR "footprint: stack probe for ${config} failed (${run_rc})")
+        endif()
+        foreach(entry process_input print_help printf)
+            if(run_out MATCHES "stack ${entry} ([0-9]+)")
+                set(stack_${entry} ${CMAKE_MATCH_1})
+            endif()
+        endforeach()
+    endif()
+
+    mcli_check(${config} TEXT ${text})
+    mcli_check(${config} DATA ${data})
+    mcli_check(${config} BSS ${bss})
+    # One stack budget per configuration: the deepest entry point has to fit
+    foreach(entry process_input print_help printf)
+        mcli_check(${config} STACK ${stack_${entry}} ${entry})
+    endforeach()
+
+    string(LENGTH "${config}" name_len)
+    set(row "${config}")
+    while(name_len LESS 8)
+        set(row "${row} ")
+        math(EXPR name_len "${name_len} + 1")
+    endwhile()
+    mcli_pad(c1 ${text} 9)
+    mcli_pad(c2 ${data} 8)
+    mcli_pad(c3 ${bss} 8)
+    mcli_pad(c4 ${stack_process_input} 16)
+    mcli_pad(c5 ${stack_print_help} 12)
+    mcli_pad(c6 ${stack_printf} 8)
+    message(STATUS "${row}${c1}${c2}${c3}${c4}${c5}${c6}")
+endforeach()
+
+message(STATUS "")
+if(failures)
+    string(REPLACE ";" "\n  " failure_text "${failures}")
+    message(FATAL_ERROR "footprint budget exceeded:\n  ${failure_text}")
+endif()
+message(STATUS "footprint within budget (${BUDGETS})")
@@ -5,44 +5,93 @@
  * Arduino Serial adapter - works with Serial, Serial1, etc.
  */
 
-class ArduinoSerialIo : public mcli::CliIoInterface {
+class ArduinoSerialIo : public mcli::CliIoAdapter<ArduinoSerialIo> {
     public:
-        ArduinoSerialIo(HardwareSerial& stream = Serial) : stream_(stream) {
-            stream.begin(9600);
-            while (!Serial) {
-                ; // Wait for serial port to connect (needed for Leonardo/Micro)
+        /**
+         * @param baud_rate Any rate the board supports; most cores go up to 2000000
+         * @param ready_timeout_ms How long to wait for the port to open (needed for
+         *        native USB boards such as Leonardo/Micro). 0 never waits, so
+         *        headless units boot without a host attached; poll ready() instead.
+         *        mcli::WAIT_FOREVER blocks until the port opens.
+         */
+        ArduinoSerialIo(HardwareSerial& stream = Serial, unsigned long baud_rate = 9600,
+                        uint32_t ready_timeout_ms = 0) : stream_(stream) {
+            stream_.begin(baud_rate);
+            wait_ready(ready_timeout_ms);
+        }
+
+        // True once the port is open (always true on plain UARTs)
+        bool ready() {
+            return static_cast<bool>(stream_);
+        }
+
+        // Wait up to timeout_ms for the port to open
+        bool wait_ready(uint32_t timeout_ms) {
+            unsigned long start = millis();
+            while (!ready()) {
+                if (timeout_ms != mcli::WAIT_FOREVER && millis() - start >= timeout_ms) {
+                    return false;
+                }
+                yield();
             }
+            return true;
         }
 
         // Required abstract methods from CliIoInterface
         void put_byte(char c) override {
             stream_.write(c);
+            note_output(1);
         }
         char get_byte() override {
-            if (!byte_available()) return 0;
-            return stream_.read();
+            int c = stream_.read();
+            if (c < 0) return 0;
+            note_input(1);
+            return (char)c;
         }
         bool byte_available() override {
             return stream_.available() > 0;
         }
 
         // Optional bulk methods
-        void put_bytes(const char* data, size_t len) {
+        void put_bytes(const char* data, size_t len) override {
             stream_.write(data, len);
+            note_output(len);
+        }
+
+        // Room in the core's TX ring, so try_put_bytes() never waits. Cores
+        // without availableForWrite() report 0; use put_bytes() on those.
+        size_t writable_space() override {
+            int space = stream_.availableForWrite();
+            return space > 0 ? (size_t)space : 0;
         }
 
         size_t get_bytes(char* buffer, size_t max_len) override {
-            size_t count = 0;
-            while (count < max_len && stream_.available()) {
-                buffer[count++] = stream_.read();
-            }
+            int available = stream_.available();
+            if (available <= 0) return 0;
+
+            // Only ask for what is already buffered so readBytes() never waits
+            size_t count = (size_t)available < max_len ? (size_t)available : max_len;
+            count = stream_.readBytes(buffer, count);
+            note_input(count);
             return count;
         }
 
-        void flush() override {
-            stream_.flush();
+        // Bare-metal cores have nothing to sleep on: yield() until data arrives
+        // (this also runs the ESP32/ESP8266 cores' background tasks)
+        bool readable_wait(uint32_t timeout_ms) override {
+            unsigned long start = millis();
+            while (stream_.available() <= 0) {
+                if (timeout_ms != mcli::WAIT_FOREVER && millis() - start >= timeout_ms) {
+                    return false;
+                }
+                yield();
+            }
+            return true;
         }
 
+        // flush() keeps the default no-op: write() already queues into the
+        // HardwareSerial TX ring, and Stream::flush() would block until it drains.
+
     private:
-        Stream& stream_;
-};
\ No newline at end of file
+        HardwareSerial& stream_;
+};
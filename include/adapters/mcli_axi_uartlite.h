@@ -0,0 +1,89 @@
+// mcli_axi_uartlite.h
+// AMD/Xilinx AXI UART Lite adapter (MicroBlaze / MicroBlaze V), register level
+#pragma once
+
+#include "mcli_isr_input_io.h"
+
+/**
+ * AXI UART Lite adapter - the core's interrupt moves received bytes into an
+ * SPSC ring, and transmit polls the 16-byte TX FIFO
+ *
+ *   AxiUartliteIo uart(XPAR_AXI_UARTLITE_0_BASEADDR);
+ *   // Route the core's interrupt to uart.handle_interrupt() through the
+ *   // interrupt controller (XIntc/AXI INTC or the RISC-V PLIC), then:
+ *   uart.enable_interrupt();
+ *
+ * Without the interrupt hooked up, call poll() from the main loop instead;
+ * it does the same FIFO drain. The baud rate is fixed in the hardware design.
+ */
+class AxiUartliteIo final : public IsrInputIo<AxiUartliteIo, 256> {
+    public:
+        explicit AxiUartliteIo(uintptr_t base_address) : base_(base_address) {
+            // Start from empty FIFOs
+            reg(CTRL) = CTRL_RST_TX | CTRL_RST_RX;
+        }
+
+        void enable_interrupt() {
+            reg(CTRL) = CTRL_ENABLE_INTR;
+        }
+
+        void disable_interrupt() {
+            reg(CTRL) = 0;
+        }
+
+        // Interrupt handler body: drain the RX FIFO into the ring
+        void handle_interrupt() {
+            while (reg(STAT) & STAT_RX_VALID) {
+                receive_from_isr(static_cast<char>(reg(RX_FIFO)));
+            }
+        }
+
+        // Polling alternative to the interrupt
+        void poll() {
+            handle_interrupt();
+        }
+
+        void put_byte(char c) override {
+            while (reg(STAT) & STAT_TX_FULL) {}
+            reg(TX_FIFO) = static_cast<uint8_t>(c);
+            note_output(1);
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            for (size_t i = 0; i < len; i++) {
+                while (reg(STAT) & STAT_TX_FULL) {}
+                reg(TX_FIFO) = static_cast<uint8_t>(data[i]);
+            }
+            note_output(len);
+        }
+
+        // The status register only tells empty, full or in between
+        size_t writable_space() override {
+            uint32_t stat = reg(STAT);
+            if (stat & STAT_TX_EMPTY) return TX_FIFO_DEPTH;
+            return (stat & STAT_TX_FULL) ? 0 : 1;
+        }
+
+    private:
+        // Register offsets and bits (PG142)
+        static constexpr uintptr_t RX_FIFO = 0x00;
+        static constexpr uintptr_t TX_FIFO = 0x04;
+        static constexpr uintptr_t STAT = 0x08;
+        static constexpr uintptr_t CTRL = 0x0C;
+
+        static constexpr uint32_t STAT_RX_VALID = 1u << 0;
+        static constexpr uint32_t STAT_TX_EMPTY = 1u << 2;
+        static constexpr uint32_t STAT_TX_FULL = 1u << 3;
+
+        static constexpr uint32_t CTRL_RST_TX = 1u << 0;
+        static constexpr uint32_t CTRL_RST_RX = 1u << 1;
+        static constexpr uint32_t CTRL_ENABLE_INTR = 1u << 4;
+
+        static constexpr size_t TX_FIFO_DEPTH = 16;
+
+        uintptr_t base_;
+
+        volatile uint32_t& reg(uintptr_t offset) const {
+            return *reinterpret_cast<volatile uint32_t*>(base_ + offset);
+        }
+};
@@ -0,0 +1,125 @@
+// mcli_buffered_io.h
+// Output-coalescing decorator for any MCLI I/O adapter
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * Buffered I/O decorator - stages output and sends it downstream in one batch
+ *
+ * Wrap a packet-based adapter (e.g. ESP32WiFiIo) so that echo, help output and
+ * the prompt leave as a single put_bytes() call instead of one per print:
+ *
+ *   ESP32WiFiIo wifi("ssid", "password");
+ *   BufferedIo<256> io(wifi);
+ *   mcli::CliEngine<MyAppContext> cli(io, ctx, commands);
+ *
+ * Staged bytes are sent when flush() is called (the engine does this at the end
+ * of every process_input() that produced output) or when the buffer fills.
+ * Writes larger than the buffer are passed straight through. Input is forwarded
+ * to the wrapped adapter unchanged.
+ */
+template<size_t BufferSize = 128>
+class BufferedIo final : public mcli::CliIoAdapter<BufferedIo<BufferSize>> {
+    static_assert(BufferSize > 0, "BufferedIo needs a non-empty staging buffer");
+
+    public:
+        explicit BufferedIo(mcli::CliIoInterface& downstream) : downstream_(downstream) {}
+
+        ~BufferedIo() override {
+            flush_buffer();
+        }
+
+        void put_byte(char c) override {
+            if (buffered_ == BufferSize) {
+                flush_buffer();
+            }
+            buffer_[buffered_++] = c;
+        }
+
+        char get_byte() override {
+            return downstream_.get_byte();
+        }
+
+        bool byte_available() override {
+            return downstream_.byte_available();
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            if (len > BufferSize - buffered_) {
+                flush_buffer();
+                if (len >= BufferSize) {
+                    // Too big to stage, send it as its own batch
+                    downstream_.put_bytes(data, len);
+                    return;
+                }
+            }
+            memcpy(buffer_ + buffered_, data, len);
+            buffered_ += len;
+        }
+
+        size_t get_bytes(char* buffer, size_t max_len) override {
+            return downstream_.get_bytes(buffer, max_len);
+        }
+
+        void flush() override {
+            flush_buffer();
+            downstream_.flush();
+        }
+
+#ifdef MCLI_ENABLE_STATS
+        // Counters belong to the link, not the staging buffer
+        mcli::IoStats& io_stats() override {
+            return downstream_.io_stats();
+        }
+#endif
+
+        // Framing happens downstream, so staged text must leave first
+        bool set_framing(bool enabled) override {
+            flush_buffer();
+            return downstream_.set_framing(enabled);
+        }
+
+        void framing_begin(uint8_t seq) override {
+            flush_buffer();
+            downstream_.framing_begin(seq);
+        }
+
+        void framing_end(mcli::FrameStatus status) override {
+            flush_buffer();
+            downstream_.framing_end(status);
+        }
+
+        // Staged bytes go out with the next flush(), so they count against the link
+        size_t writable_space() override {
+            size_t space = downstream_.writable_space();
+            if (space == mcli::WRITE_SPACE_UNLIMITED) return space;
+            return (space > buffered_) ? space - buffered_ : 0;
+        }
+
+        bool readable_wait(uint32_t timeout_ms) override {
+            // Don't sleep on staged output
+            flush();
+            return downstream_.readable_wait(timeout_ms);
+        }
+
+        bool idle_wait(uint32_t timeout_ms) override {
+            flush();
+            return downstream_.idle_wait(timeout_ms);
+        }
+
+        // Bytes currently staged and not yet sent downstream
+        size_t buffered() const { return buffered_; }
+
+    private:
+        mcli::CliIoInterface& downstream_;
+        char buffer_[BufferSize];
+        size_t buffered_ = 0;
+
+        void flush_buffer() {
+            if (buffered_ > 0) {
+                downstream_.put_bytes(buffer_, buffered_);
+                buffered_ = 0;
+            }
+        }
+};
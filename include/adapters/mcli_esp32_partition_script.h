@@ -0,0 +1,69 @@
+// mcli_esp32_partition_script.h
+// Script stored in a raw ESP32 data partition, run straight from memory-mapped flash
+#pragma once
+
+#include "esp_partition.h"
+#include "esp_log.h"
+
+#include "mcli.h"
+
+/**
+ * Partition script - maps a data partition holding a plain text script
+ *
+ * Flash the script with e.g. `parttool.py write_partition --partition-name
+ * cli_script --input boot.cli`, then:
+ *
+ *   ESP32PartitionScript script("cli_script");
+ *   if (script.valid()) {
+ *       cli.execute_script(script.data(), script.length());
+ *   }
+ *
+ * The script ends at the first NUL or erased (0xFF) byte, or at the end of
+ * the partition. Nothing is copied to RAM except one line at a time.
+ */
+class ESP32PartitionScript {
+    public:
+        explicit ESP32PartitionScript(const char* label) {
+            const esp_partition_t* partition =
+                esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+            if (!partition) {
+                ESP_LOGE("ESP32PartitionScript", "No data partition \"%s\"", label);
+                return;
+            }
+
+            const void* mapped = nullptr;
+            esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                               &mapped, &handle_);
+            if (err != ESP_OK) {
+                ESP_LOGE("ESP32PartitionScript", "Mapping \"%s\" failed: %s", label, esp_err_to_name(err));
+                return;
+            }
+            data_ = static_cast<const char*>(mapped);
+            mapped_ = true;
+
+            while (length_ < partition->size) {
+                uint8_t c = static_cast<uint8_t>(data_[length_]);
+                if (c == 0x00 || c == 0xFF) break;
+                length_++;
+            }
+        }
+
+        ~ESP32PartitionScript() {
+            if (mapped_) {
+                esp_partition_munmap(handle_);
+            }
+        }
+
+        ESP32PartitionScript(const ESP32PartitionScript&) = delete;
+        ESP32PartitionScript& operator=(const ESP32PartitionScript&) = delete;
+
+        bool valid() const { return mapped_; }
+        const char* data() const { return data_; }
+        size_t length() const { return length_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t length_ = 0;
+        esp_partition_mmap_handle_t handle_ = 0;
+        bool mapped_ = false;
+};
@@ -6,26 +6,87 @@
 #include "driver/uart.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 
 
-class ESP32UartIo : public mcli::CliIoInterface {
+class ESP32UartIo : public mcli::CliIoAdapter<ESP32UartIo> {
     public:
+        /**
+         * What idle_wait() does once the engine's idle timeout passes (see
+         * CliEngine::set_idle_timeout()):
+         *   Wait            same as readable_wait()
+         *   AutoLightSleep  hold a no-light-sleep PM lock while the console is in
+         *                   use and release it when idle, so the power manager
+         *                   (esp_pm_configure() with light_sleep_enable) can sleep
+         *   LightSleep      enter esp_light_sleep_start() from the console task;
+         *                   the whole chip stops, so only for single-task firmware
+         * Both sleep modes wake on UART RX. The chip wakes after wakeup_threshold
+         * RX edges, and the characters that cause them are not received.
+         */
+        enum class IdleMode : uint8_t { Wait, AutoLightSleep, LightSleep };
+
+        /**
+         * Driver setup. The defaults match the polling constructor; set a TX
+         * buffer so writes return as soon as they are queued, and an event queue
+         * so the console task can sleep in wait_for_input() instead of polling.
+         */
+        struct Config {
+            int baud_rate = 115200;
+            gpio_num_t tx_pin = GPIO_NUM_1;
+            gpio_num_t rx_pin = GPIO_NUM_3;
+            int rx_buffer_size = 1024;
+            int tx_buffer_size = 0;     // 0 = writes block until sent
+            int event_queue_size = 0;   // 0 = polling mode, no event queue
+            bool line_detect = false;   // Wake wait_for_input() only on '\r' (needs the event queue)
+            IdleMode idle_mode = IdleMode::Wait;
+            int wakeup_threshold = 3;   // RX edges that wake the chip from light sleep
+        };
+
         ESP32UartIo(uart_port_t uart_num = UART_NUM_0, int baud_rate = 115200, gpio_num_t tx_pin = GPIO_NUM_1, gpio_num_t rx_pin = GPIO_NUM_3)
         : uart_num_(uart_num) {
-            init_uart(baud_rate, tx_pin, rx_pin);
+            Config config;
+            config.baud_rate = baud_rate;
+            config.tx_pin = tx_pin;
+            config.rx_pin = rx_pin;
+            init_uart(config);
+        }
+
+        ESP32UartIo(uart_port_t uart_num, const Config& config)
+        : uart_num_(uart_num) {
+            init_uart(config);
+        }
+
+        ~ESP32UartIo() {
+            if (pm_lock_) {
+                esp_pm_lock_release(pm_lock_);
+                esp_pm_lock_delete(pm_lock_);
+            }
         }
 
         void put_byte(char c) override {
             uart_write_bytes(uart_num_, &c, 1);
+            note_output(1);
         }
 
         char get_byte() override {
+            if (lookahead_ >= 0) {
+                char c = (char)lookahead_;
+                lookahead_ = -1;
+                return c;
+            }
             char c;
-            int len = uart_read_bytes(uart_num_, (uint8_t*)&c, 1, pdMS_TO_TICKS(5)); //5ms timeout, non-blocking
-            return (len == 1) ? c : 0;
+            int len = uart_read_bytes(uart_num_, (uint8_t*)&c, 1, read_timeout_); //5ms timeout in polling mode, 0 in event mode
+            if (len != 1) return 0;
+            note_input(1);
+            return c;
         }
 
         bool byte_available() override {
+            if (lookahead_ >= 0) return true;
             size_t buffered_size = 0;
             uart_get_buffered_data_len(uart_num_, &buffered_size);
             return buffered_size > 0;
@@ -33,21 +94,178 @@ class ESP32UartIo : public mcli::CliIoInterface {
 
         void put_bytes(const char* data, size_t len) override {
             uart_write_bytes(uart_num_, data, len);
+            note_output(len);
+        }
+
+        // Free TX ring space, or the hardware FIFO once it has emptied out
+        size_t writable_space() override {
+            if (tx_buffer_size_ > 0) {
+                size_t free_size = 0;
+                uart_get_tx_buffer_free_size(uart_num_, &free_size);
+                return free_size;
+            }
+            return (uart_wait_tx_done(uart_num_, 0) == ESP_OK) ? UART_HW_FIFO_LEN(uart_num_) : 0;
+        }
+
+        size_t try_put_bytes(const char* data, size_t len) override {
+            if (tx_buffer_size_ > 0) {
+                return mcli::CliIoAdapter<ESP32UartIo>::try_put_bytes(data, len);
+            }
+            // No TX ring: fill whatever the FIFO has room for and return
+            int sent = uart_tx_chars(uart_num_, data, len);
+            if (sent <= 0) return 0;
+            note_output(sent);
+            if ((size_t)sent < len) note_partial_send();
+            return sent;
         }
 
         size_t get_bytes(char* buffer, size_t max_len) override {
-            int len = uart_read_bytes(uart_num_, (uint8_t*)buffer, max_len, pdMS_TO_TICKS(5)); //5ms timeout, non-blocking
-            return (len > 0) ? len : 0;
+            size_t count = 0;
+            if (lookahead_ >= 0 && max_len > 0) {
+                // Byte already pulled in by readable_wait()
+                buffer[count++] = (char)lookahead_;
+                lookahead_ = -1;
+                if (!byte_available()) return count;
+            }
+            int len = uart_read_bytes(uart_num_, (uint8_t*)buffer + count, max_len - count, read_timeout_); //5ms timeout in polling mode, 0 in event mode
+            if (len > 0) {
+                note_input(len);
+                count += len;
+            }
+            return count;
         }
 
+        /**
+         * Event mode sleeps on the driver's event queue (see wait_for_input());
+         * polling mode blocks in the driver for the first byte and keeps it for
+         * the next read.
+         */
+        bool readable_wait(uint32_t timeout_ms) override {
+            TickType_t ticks = (timeout_ms == mcli::WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+            if (event_queue_) {
+                return wait_for_input(ticks);
+            }
+            if (byte_available()) return true;
+
+            uint8_t c;
+            if (uart_read_bytes(uart_num_, &c, 1, ticks) != 1) return false;
+            note_input(1);
+            lookahead_ = c;
+            return true;
+        }
+
+        /**
+         * Light-sleep-capable wait (see IdleMode). Output is drained first so no
+         * byte is cut off when the clocks stop, and input that is already
+         * buffered skips the sleep. RX data that arrives after the wakeup
+         * characters lands in the driver buffer as usual.
+         */
+        bool idle_wait(uint32_t timeout_ms) override {
+            if (idle_mode_ == IdleMode::Wait || (idle_mode_ == IdleMode::AutoLightSleep && !pm_lock_)) {
+                return readable_wait(timeout_ms);
+            }
+
+            uart_wait_tx_done(uart_num_, portMAX_DELAY);
+            if (byte_available()) return true;
+
+            esp_sleep_enable_uart_wakeup(uart_num_);
+            bool ready;
+            if (idle_mode_ == IdleMode::AutoLightSleep) {
+                esp_pm_lock_release(pm_lock_);
+                ready = readable_wait(timeout_ms);
+                esp_pm_lock_acquire(pm_lock_);
+            } else {
+                bool timed = timeout_ms != mcli::WAIT_FOREVER;
+                if (timed) {
+                    esp_sleep_enable_timer_wakeup((uint64_t)timeout_ms * 1000);
+                }
+                esp_light_sleep_start();
+                if (timed) {
+                    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+                }
+                ready = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UART || byte_available();
+            }
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+            light_sleeps_++;
+            return ready;
+        }
+
+        /**
+         * Event mode only: sleep on the UART event queue until input arrives (or,
+         * with line_detect, until a complete '\r'-terminated line is buffered).
+         * FIFO/buffer overflows are cleared here so reception keeps going.
+         * @return true if there is input to process, false on timeout
+         */
+        bool wait_for_input(TickType_t timeout) {
+            if (!event_queue_) {
+                return byte_available();
+            }
+            if (!line_detect_ && byte_available()) {
+                return true;
+            }
+
+            TickType_t start = xTaskGetTickCount();
+            TickType_t remaining = timeout;
+            while (true) {
+                uart_event_t event;
+                if (xQueueReceive(event_queue_, &event, remaining) != pdTRUE) {
+                    return false;
+                }
+
+                switch (event.type) {
+                    case UART_DATA:
+                        // Events queue up while the engine reads, so skip ones already consumed
+                        if (!line_detect_ && byte_available()) return true;
+                        break;
+                    case UART_PATTERN_DET:
+                        // Keep the pattern position queue from filling up
+                        uart_pattern_pop_pos(uart_num_);
+                        return true;
+                    case UART_FIFO_OVF:
+                    case UART_BUFFER_FULL:
+                        ESP_LOGW("ESP32UartIo", "RX overflow, input discarded");
+                        overflows_++;
+                        note_input(0, event.size);
+                        uart_flush_input(uart_num_);
+                        xQueueReset(event_queue_);
+                        break;
+                    default:
+                        break;
+                }
+
+                if (timeout != portMAX_DELAY) {
+                    TickType_t elapsed = xTaskGetTickCount() - start;
+                    if (elapsed >= timeout) return false;
+                    remaining = timeout - elapsed;
+                }
+            }
+        }
+
+        // Raw UART event queue (nullptr in polling mode)
+        QueueHandle_t event_queue() const { return event_queue_; }
+
+        // RX overflows seen by wait_for_input()
+        uint32_t overflow_count() const { return overflows_; }
+
+        // Times idle_wait() armed light sleep
+        uint32_t light_sleep_count() const { return light_sleeps_; }
 
     private:
         uart_port_t uart_num_;
+        QueueHandle_t event_queue_ = nullptr;
+        TickType_t read_timeout_ = pdMS_TO_TICKS(5);
+        bool line_detect_ = false;
+        uint32_t overflows_ = 0;
+        int lookahead_ = -1;
+        int tx_buffer_size_ = 0;
+        IdleMode idle_mode_ = IdleMode::Wait;
+        esp_pm_lock_handle_t pm_lock_ = nullptr;
+        uint32_t light_sleeps_ = 0;
 
-        void init_uart(int baud_rate, gpio_num_t tx_pin, gpio_num_t rx_pin) {
+        void init_uart(const Config& config) {
             // UART configuration
             uart_config_t uart_config = {
-                .baud_rate = baud_rate,
+                .baud_rate = config.baud_rate,
                 .data_bits = UART_DATA_8_BITS,
                 .parity    = UART_PARITY_DISABLE,
                 .stop_bits = UART_STOP_BITS_1,
@@ -57,9 +275,38 @@ class ESP32UartIo : public mcli::CliIoInterface {
                 .flags = 0,
             };
 
+            tx_buffer_size_ = config.tx_buffer_size;
+
             // Configure UART parameters
             ESP_ERROR_CHECK(uart_param_config(uart_num_, &uart_config));
-            ESP_ERROR_CHECK(uart_set_pin(uart_num_, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-            ESP_ERROR_CHECK(uart_driver_install(uart_num_, 1024, 0, 0, nullptr, 0));
+            ESP_ERROR_CHECK(uart_set_pin(uart_num_, config.tx_pin, config.rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+            ESP_ERROR_CHECK(uart_driver_install(uart_num_, config.rx_buffer_size, config.tx_buffer_size,
+                                                config.event_queue_size,
+                                                config.event_queue_size > 0 ? &event_queue_ : nullptr, 0));
+
+            idle_mode_ = config.idle_mode;
+            if (idle_mode_ != IdleMode::Wait) {
+                ESP_ERROR_CHECK(uart_set_wakeup_threshold(uart_num_, config.wakeup_threshold));
+            }
+            if (idle_mode_ == IdleMode::AutoLightSleep) {
+                // Held except inside idle_wait(): light sleep must not cut into typing
+                if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "mcli_uart", &pm_lock_) == ESP_OK) {
+                    esp_pm_lock_acquire(pm_lock_);
+                } else {
+                    ESP_LOGW("ESP32UartIo", "No PM support (CONFIG_PM_ENABLE), idle mode falls back to waiting");
+                    pm_lock_ = nullptr;
+                }
+            }
+
+            if (event_queue_) {
+                // Reads never wait: wait_for_input() is where the task sleeps
+                read_timeout_ = 0;
+
+                if (config.line_detect) {
+                    line_detect_ = true;
+                    ESP_ERROR_CHECK(uart_enable_pattern_det_baud_intr(uart_num_, '\r', 1, 9, 0, 0));
+                    ESP_ERROR_CHECK(uart_pattern_queue_reset(uart_num_, config.event_queue_size));
+                }
+            }
         }
-};
\ No newline at end of file
+};
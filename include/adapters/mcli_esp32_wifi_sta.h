@@ -1,6 +1,7 @@
 // mcli_esp32_wifi_sta.h
-// ESP32 WiFi I/O adapter for MCLI - Single client version
-// Handles WiFi connection and accepts ONE client at a time
+// ESP32 WiFi I/O adapters for MCLI
+// ESP32WiFiIo handles WiFi connection and accepts ONE client at a time.
+// ESP32TelnetServer keeps a listener open and serves several clients from one task.
 
 #pragma once
 
@@ -25,149 +26,27 @@
 #define WIFI_FAIL_BIT      BIT1
 
 /**
- * ESP32 WiFi I/O adapter - Single client version
- * Connects to WiFi, waits for ONE client, provides I/O interface
+ * ESP32 WiFi station - joins the network (blocking) and retries on disconnect
  */
-class ESP32WiFiIo : public mcli::CliIoInterface {
+class ESP32WiFiStation {
 public:
-    ESP32WiFiIo(const char* ssid, const char* password, int port = 23) 
-        : ssid_(ssid), password_(password), port_(port),
-          socket_fd_(-1), connected_(false) {
+    ESP32WiFiStation(const char* ssid, const char* password)
+        : ssid_(ssid), password_(password) {
 
         s_wifi_event_group = xEventGroupCreate();
         ESP_LOGI("ESP32WiFiIo", "Starting WiFi...");
         connect_wifi();
     }
 
-    // Connect to WiFi and wait for a client (blocking)
-    bool wait_for_client() {
-    
-        ESP_LOGI("ESP32WiFiIo", "Waiting for client on port %d...", port_);
-        return accept_client();
-    }
-
-    // Get the client socket (for context creation)
-    int get_client_socket() const { return socket_fd_; }
-
-    // CliIoInterface implementation
-    bool is_connected() const {
-        return connected_;
-    }
-
-    void put_byte(char c) override {
-        put_bytes(&c, 1);
-    }
-
-    char get_byte() override {
-        if (!connected_ || socket_fd_ < 0) return 0;
-        char c;
-        return (get_bytes(&c, 1) == 1) ? c : 0;
-    }
-
-    bool byte_available() override {
-        if (!connected_ || socket_fd_ < 0) return false;
-        
-        char temp;
-        int result = recv(socket_fd_, &temp, 1, MSG_PEEK);
-        if (result <= 0) {
-            if (result == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-                connected_ = false;
-            }
-            return false;
-        }
-        return true;
-    }
-
-    size_t get_bytes(char* buffer, size_t max_len) override {
-        if (!connected_ || socket_fd_ < 0) return 0;
-        
-        int result = recv(socket_fd_, buffer, max_len, 0);
-        if (result <= 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                connected_ = false;
-            }
-            return 0;
-        } else if (result == 0) {
-            connected_ = false;
-            return 0;
-        }
-
-        // Filter out telnet commands in-place
-        size_t write_pos = 0;
-        for (int read_pos = 0; read_pos < result; read_pos++) {
-            unsigned char c = buffer[read_pos];
-
-            // Handle telnet data
-            if (c == 0xFF) {
-                // Skip telnet command sequence (usually 3 bytes)
-                if (read_pos + 2 < result) {
-                    read_pos += 2; // Skip the next 2 bytes
-                } else {
-                    // Command sequence incomplete, skip rest
-                    break;
-                }
-            } else {
-                // Keep regular character, compact the buffer
-                buffer[write_pos++] = c;
-            }
-        }
-        
-        return write_pos;
-    }
-
-    void put_bytes(const char* data, size_t len) override {
-        if (!connected_ || socket_fd_ < 0) return;
-
-        const size_t CHUNK_SIZE = 32; // Send 32 bytes at a time
-        size_t offset = 0;
-
-        while (offset < len) {
-            size_t chunk_len = (len - offset < CHUNK_SIZE) ? (len - offset) : CHUNK_SIZE;
-
-            int result = send(socket_fd_, data + offset, chunk_len, 0);
-
-            if (result < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    // Brief pause and retry this chunk
-                    vTaskDelay(pdMS_TO_TICKS(1));
-                    continue;
-                } else {
-                    ESP_LOGE("TCP", "send failed: errno=%d (%s)", errno, strerror(errno));
-                    connected_ = false;
-                    return;
-                }
-            } else if (result == 0) {
-                ESP_LOGW("TCP", "send returned 0");
-                break;
-            } else {
-                offset += result;
-                // Small delay between chunks to avoid overwhelming the buffer
-                if (offset < len) {
-                    vTaskDelay(pdMS_TO_TICKS(1)); 
-                }
-            }
-        }
-    }
-
 private:
     const char* ssid_;
     const char* password_;
-    int port_;
     EventGroupHandle_t s_wifi_event_group;
-    
-    int socket_fd_;
-    bool connected_;
-
-    void send_telnet_response(char byte1, char byte2) {
-        put_byte(0xFF);
-        put_byte(byte1);
-        put_byte(byte2);
-    }
 
     // WiFi event handler
     static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
-        ESP32WiFiIo* adapter = static_cast<ESP32WiFiIo*>(arg);
-        
+        ESP32WiFiStation* station = static_cast<ESP32WiFiStation*>(arg);
+
         if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
             esp_wifi_connect();
         } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
@@ -176,14 +55,14 @@ private:
         } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
             ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
             ESP_LOGI("WiFi", "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-            xEventGroupSetBits(adapter->s_wifi_event_group, WIFI_CONNECTED_BIT);
+            xEventGroupSetBits(station->s_wifi_event_group, WIFI_CONNECTED_BIT);
         }
     }
 
     void connect_wifi() {
         // Initialize NVS
         ESP_ERROR_CHECK(nvs_flash_init());
-        
+
         // Initialize network interface
         ESP_ERROR_CHECK(esp_netif_init());
         ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -201,7 +80,7 @@ private:
         wifi_config_t wifi_config = {};
         strcpy((char*)wifi_config.sta.ssid, ssid_);
         strcpy((char*)wifi_config.sta.password, password_);
-        
+
         ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
         ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
         ESP_ERROR_CHECK(esp_wifi_start());
@@ -216,25 +95,641 @@ private:
             ESP_LOGE("WiFi", "Failed to connect to %s", ssid_);
         }
     }
-    
+};
 
-    bool accept_client() {
+/**
+ * Resumable telnet (RFC 854) input filter with minimal option negotiation
+ *
+ * Strips commands from received data in place and keeps its state between
+ * calls, so sequences split across reads are handled and bulk pastes are not
+ * lost. IAC IAC is passed on as a 0xFF data byte, subnegotiations (IAC SB ...
+ * IAC SE) are consumed, CR NUL becomes CR and IAC IP becomes Ctrl-C.
+ *
+ * We offer ECHO and SUPPRESS-GO-AHEAD, and ask the client for NAWS (window
+ * size). LINEMODE can be switched on and off at runtime with request_linemode().
+ * Replies are queued internally; the owner sends them with replies().
+ * Negotiation only answers state changes, so it cannot loop.
+ */
+class TelnetFilter {
+public:
+    // Telnet commands
+    static constexpr uint8_t IAC  = 255;
+    static constexpr uint8_t DONT = 254;
+    static constexpr uint8_t DO   = 253;
+    static constexpr uint8_t WONT = 252;
+    static constexpr uint8_t WILL = 251;
+    static constexpr uint8_t SB   = 250;
+    static constexpr uint8_t IP   = 244;
+    static constexpr uint8_t SE   = 240;
+
+    // Options we negotiate
+    static constexpr uint8_t OPT_ECHO     = 1;
+    static constexpr uint8_t OPT_SGA      = 3;
+    static constexpr uint8_t OPT_NAWS     = 31;
+    static constexpr uint8_t OPT_LINEMODE = 34;
+
+    TelnetFilter() { reset(); }
+
+    void reset() {
+        state_ = State::Data;
+        verb_ = 0;
+        sb_len_ = 0;
+        local_enabled_ = local_pending_ = 0;
+        remote_enabled_ = remote_pending_ = 0;
+        local_wanted_ = bit(OPT_ECHO) | bit(OPT_SGA);
+        remote_wanted_ = bit(OPT_NAWS);
+        reply_len_ = 0;
+        width_ = height_ = 0;
+    }
 
-        // Close any exisiting socket_fd_ if open!
+    // Initial offers for a freshly connected client
+    void start() {
+        request_local(OPT_ECHO, true);
+        request_local(OPT_SGA, true);
+        request_remote(OPT_NAWS, true);
+    }
+
+    /**
+     * Ask the client to edit lines locally (true) or to send every keystroke
+     * and leave echo to us (false). Pair linemode with the engine's batch mode
+     * so lines are not echoed twice.
+     */
+    void request_linemode(bool enabled) {
+        if (enabled) {
+            remote_wanted_ |= bit(OPT_LINEMODE);
+            local_wanted_ &= static_cast<uint8_t>(~bit(OPT_ECHO));
+            request_local(OPT_ECHO, false);
+            request_remote(OPT_LINEMODE, true);
+        } else {
+            remote_wanted_ &= static_cast<uint8_t>(~bit(OPT_LINEMODE));
+            local_wanted_ |= bit(OPT_ECHO);
+            request_remote(OPT_LINEMODE, false);
+            request_local(OPT_ECHO, true);
+        }
+    }
+
+    bool linemode() const { return (remote_enabled_ & bit(OPT_LINEMODE)) != 0; }
+
+    // Client window size from NAWS, 0 until reported
+    uint16_t window_width() const { return width_; }
+    uint16_t window_height() const { return height_; }
+
+    // Filter received bytes in place, returns the number of data bytes kept
+    size_t filter(char* buffer, size_t len) {
+        size_t write_pos = 0;
+        for (size_t read_pos = 0; read_pos < len; read_pos++) {
+            uint8_t c = static_cast<uint8_t>(buffer[read_pos]);
+
+            switch (state_) {
+                case State::Data:
+                case State::Cr:
+                    if (c == IAC) {
+                        state_ = State::Iac;
+                    } else if (state_ == State::Cr && c == 0) {
+                        state_ = State::Data; // CR NUL means a bare CR
+                    } else {
+                        buffer[write_pos++] = static_cast<char>(c);
+                        state_ = (c == '\r') ? State::Cr : State::Data;
+                    }
+                    break;
+
+                case State::Iac:
+                    if (c == IAC) {
+                        buffer[write_pos++] = static_cast<char>(0xFF); // Escaped data byte
+                        state_ = State::Data;
+                    } else if (c >= WILL) {
+                        verb_ = c;
+                        state_ = State::Option;
+                    } else if (c == SB) {
+                        sb_len_ = 0;
+                        state_ = State::Sb;
+                    } else {
+                        if (c == IP) {
+                            buffer[write_pos++] = 0x03; // Interrupt process -> Ctrl-C
+                        }
+                        state_ = State::Data;
+                    }
+                    break;
+
+                case State::Option:
+                    negotiate(verb_, c);
+                    state_ = State::Data;
+                    break;
+
+                case State::Sb:
+                    if (c == IAC) {
+                        state_ = State::SbIac;
+                    } else {
+                        sb_push(c);
+                    }
+                    break;
+
+                case State::SbIac:
+                    if (c == IAC) {
+                        sb_push(c);
+                        state_ = State::Sb;
+                    } else if (c == SE) {
+                        subnegotiation();
+                        state_ = State::Data;
+                    } else {
+                        // Malformed; drop the subnegotiation and carry on
+                        state_ = State::Data;
+                    }
+                    break;
+            }
+        }
+        return write_pos;
+    }
+
+    // Negotiation bytes waiting to be sent
+    const char* replies() const { return reply_; }
+    size_t reply_length() const { return reply_len_; }
+    void clear_replies() { reply_len_ = 0; }
+
+private:
+    enum class State : uint8_t { Data, Cr, Iac, Option, Sb, SbIac };
+
+    State state_;
+    uint8_t verb_;
+
+    uint8_t sb_[8];
+    size_t sb_len_;
+
+    // One bit per negotiated option (see bit())
+    uint8_t local_enabled_, local_pending_, local_wanted_;
+    uint8_t remote_enabled_, remote_pending_, remote_wanted_;
+
+    char reply_[48];
+    size_t reply_len_;
+
+    uint16_t width_, height_;
+
+    static uint8_t bit(uint8_t option) {
+        switch (option) {
+            case OPT_ECHO:     return 0x01;
+            case OPT_SGA:      return 0x02;
+            case OPT_NAWS:     return 0x04;
+            case OPT_LINEMODE: return 0x08;
+            default:           return 0;
+        }
+    }
+
+    void reply(uint8_t verb, uint8_t option) {
+        if (reply_len_ + 3 > sizeof(reply_)) return;
+        reply_[reply_len_++] = static_cast<char>(IAC);
+        reply_[reply_len_++] = static_cast<char>(verb);
+        reply_[reply_len_++] = static_cast<char>(option);
+    }
+
+    void sb_push(uint8_t c) {
+        if (sb_len_ < sizeof(sb_)) {
+            sb_[sb_len_++] = c;
+        }
+    }
+
+    // Our side of an option (WILL/WONT)
+    void request_local(uint8_t option, bool enable) {
+        uint8_t b = bit(option);
+        bool enabled = (local_enabled_ & b) != 0;
+        if (enabled == enable && !(local_pending_ & b)) return;
+        if (enable) local_enabled_ |= b; else local_enabled_ &= static_cast<uint8_t>(~b);
+        local_pending_ |= b;
+        reply(enable ? WILL : WONT, option);
+    }
+
+    // The client's side of an option (DO/DONT)
+    void request_remote(uint8_t option, bool enable) {
+        uint8_t b = bit(option);
+        bool enabled = (remote_enabled_ & b) != 0;
+        if (enabled == enable && !(remote_pending_ & b)) return;
+        if (enable) remote_enabled_ |= b; else remote_enabled_ &= static_cast<uint8_t>(~b);
+        remote_pending_ |= b;
+        reply(enable ? DO : DONT, option);
+    }
+
+    void negotiate(uint8_t verb, uint8_t option) {
+        uint8_t b = bit(option);
+        bool wanted;
+        uint8_t* enabled;
+        uint8_t* pending;
+        uint8_t agree, refuse;
+
+        if (verb == DO || verb == DONT) {
+            wanted = (local_wanted_ & b) != 0;
+            enabled = &local_enabled_;
+            pending = &local_pending_;
+            agree = WILL;
+            refuse = WONT;
+        } else {
+            wanted = (remote_wanted_ & b) != 0;
+            enabled = &remote_enabled_;
+            pending = &remote_pending_;
+            agree = DO;
+            refuse = DONT;
+        }
+
+        // Our own requests flip the enabled bit optimistically and mark it pending,
+        // so the peer's answer to one of them never needs a reply
+        bool was_pending = (*pending & b) != 0;
+        bool was_enabled = (*enabled & b) != 0;
+        *pending &= static_cast<uint8_t>(~b);
+
+        if (verb == DO || verb == WILL) {
+            if (b && wanted) {
+                if (!was_enabled) {
+                    *enabled |= b;
+                    reply(agree, option);
+                }
+                if (verb == WILL && option == OPT_LINEMODE && (!was_enabled || was_pending)) {
+                    send_linemode_edit();
+                }
+            } else {
+                *enabled &= static_cast<uint8_t>(~b);
+                reply(refuse, option);
+            }
+        } else if (was_enabled) {
+            *enabled &= static_cast<uint8_t>(~b);
+            if (!was_pending) {
+                reply(refuse, option);
+            }
+        }
+    }
+
+    // IAC SB LINEMODE MODE EDIT IAC SE
+    void send_linemode_edit() {
+        if (reply_len_ + 7 > sizeof(reply_)) return;
+        const char mode[7] = {static_cast<char>(IAC), static_cast<char>(SB), static_cast<char>(OPT_LINEMODE),
+                              1 /* MODE */, 1 /* EDIT */, static_cast<char>(IAC), static_cast<char>(SE)};
+        memcpy(reply_ + reply_len_, mode, sizeof(mode));
+        reply_len_ += sizeof(mode);
+    }
+
+    void subnegotiation() {
+        if (sb_len_ >= 5 && sb_[0] == OPT_NAWS) {
+            width_ = static_cast<uint16_t>((sb_[1] << 8) | sb_[2]);
+            height_ = static_cast<uint16_t>((sb_[3] << 8) | sb_[4]);
+        }
+        // LINEMODE SLC/FORWARDMASK/MODE ACK need no answer from us
+    }
+};
+
+/**
+ * Telnet I/O over one connected, non-blocking TCP socket
+ * Used directly by ESP32WiFiIo and once per session by ESP32TelnetServer
+ *
+ * Output is handed to lwIP without blocking. Whatever the socket cannot take
+ * right away is queued in a TxBufferSize ring that drains opportunistically
+ * whenever the engine polls for input or flushes. Only when the ring is full
+ * does put_bytes() wait, on select() writability rather than fixed delays.
+ *
+ * Input polling never peeks: byte_available()/get_byte() are served from an
+ * RxBufferSize buffer filled by one bulk non-blocking recv(), and get_bytes()
+ * receives straight into the caller's buffer when nothing is buffered.
+ */
+template<size_t TxBufferSize = 1024, size_t RxBufferSize = 128>
+class ESP32TelnetSocketIo : public mcli::CliIoAdapter<ESP32TelnetSocketIo<TxBufferSize, RxBufferSize>> {
+    static_assert(TxBufferSize > 0, "Telnet TX ring needs at least one byte");
+    static_assert(RxBufferSize > 0, "Telnet RX buffer needs at least one byte");
+
+public:
+    ESP32TelnetSocketIo() : socket_fd_(-1), connected_(false) {}
+
+    ~ESP32TelnetSocketIo() override {
+        close_socket();
+    }
+
+    // Take ownership of an accepted socket and do the telnet setup
+    bool attach(int socket_fd) {
+        close_socket();
+        socket_fd_ = socket_fd;
+
+        // Make socket non-blocking
+        int flags = fcntl(socket_fd_, F_GETFL, 0);
+        if (flags < 0) {
+            ESP_LOGE("TCP", "Failed to get socket flags: errno=%d", errno);
+            close_socket();
+            return false;
+        }
+        if (fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK) < 0) {
+            ESP_LOGE("TCP", "Failed to set non-blocking: errno=%d", errno);
+            close_socket();
+            return false;
+        }
+
+        int nodelay = 1;
+        if (setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+            ESP_LOGW("TCP", "Failed to set TCP_NODELAY: errno=%d", errno);
+        }
+
+        connected_ = true;
+        ESP_LOGI("TCP", "Client connected on socket %d", socket_fd_);
+
+        // Do some telnet setup: WILL echo, WILL suppress go ahead, DO window size
+        telnet_.reset();
+        telnet_.start();
+        send_telnet_replies();
+
+        return true;
+    }
+
+    /**
+     * Switch the client between character-at-a-time (we echo) and linemode
+     * (the client edits and echoes lines locally). Put the engine in batch
+     * mode while linemode is on.
+     */
+    void set_linemode(bool enabled) {
+        telnet_.request_linemode(enabled);
+        send_telnet_replies();
+    }
+
+    bool linemode() const { return telnet_.linemode(); }
+
+    /**
+     * Let idle_wait() put the radio in WIFI_PS_MAX_MODEM while the console is
+     * idle, restoring the previous power-save mode on wakeup. The station stays
+     * associated and TCP delivers whatever arrives meanwhile, at the cost of
+     * some latency on the first keystroke. Modem sleep is global, so leave it
+     * off when other code manages esp_wifi_set_ps().
+     */
+    void set_idle_modem_sleep(bool enabled) { idle_modem_sleep_ = enabled; }
+
+    // Client terminal size reported through NAWS, 0 until known
+    uint16_t window_width() const { return telnet_.window_width(); }
+    uint16_t window_height() const { return telnet_.window_height(); }
+
+    void close_socket() {
         if (socket_fd_ >= 0) {
-            ESP_LOGI("TCP", "Closing existing socket %d", socket_fd_);
+            ESP_LOGI("TCP", "Closing socket %d", socket_fd_);
             close(socket_fd_);
             socket_fd_ = -1;
         }
-        
-        // Reset connection state
         connected_ = false;
+        rx_pos_ = 0;
+        rx_len_ = 0;
+        tx_head_ = 0;
+        tx_count_ = 0;
+    }
+
+    // Get the client socket (for context creation)
+    int get_client_socket() const { return socket_fd_; }
+
+    // CliIoInterface implementation
+    bool is_connected() const {
+        return connected_;
+    }
+
+    void put_byte(char c) override {
+        put_bytes(&c, 1);
+    }
+
+    char get_byte() override {
+        if (!byte_available()) return 0;
+        rx_len_--;
+        return rx_buffer_[rx_pos_++];
+    }
+
+    // Served from RAM; touches the socket (one bulk recv) only when the buffer is empty
+    bool byte_available() override {
+        if (rx_len_ > 0) return true;
+        if (!connected_ || socket_fd_ < 0) return false;
+        drain_tx();
+
+        rx_pos_ = 0;
+        rx_len_ = receive(rx_buffer_, RxBufferSize);
+        return rx_len_ > 0;
+    }
+
+    size_t get_bytes(char* buffer, size_t max_len) override {
+        // Hand out anything buffered by byte_available() first
+        if (rx_len_ > 0) {
+            size_t count = (rx_len_ < max_len) ? rx_len_ : max_len;
+            memcpy(buffer, rx_buffer_ + rx_pos_, count);
+            rx_pos_ += count;
+            rx_len_ -= count;
+            return count;
+        }
+
+        if (!connected_ || socket_fd_ < 0) return 0;
+        drain_tx();
+
+        // Nothing buffered: receive straight into the caller's buffer
+        return receive(buffer, max_len);
+    }
+
+    void put_bytes(const char* data, size_t len) override {
+        if (!connected_ || socket_fd_ < 0) return;
+        this->note_output(len);
+
+        // Nothing queued ahead of us, so offer it to the socket directly
+        if (tx_count_ == 0) {
+            size_t sent = send_some(data, len);
+            data += sent;
+            len -= sent;
+        }
+
+        while (len > 0 && connected_) {
+            size_t queued = tx_push(data, len);
+            data += queued;
+            len -= queued;
+
+            if (len > 0) {
+                // Ring is full: sleep until lwIP has room, then make some
+                wait_writable(1000);
+                drain_tx();
+            }
+        }
+    }
+
+    // Never waits: what the socket cannot take goes into the ring, until it is full.
+    // Returns 0 once the client is gone, where put_bytes() would silently drop.
+    size_t try_put_bytes(const char* data, size_t len) override {
+        if (!connected_ || socket_fd_ < 0) return 0;
+        drain_tx();
+
+        size_t accepted = 0;
+        if (tx_count_ == 0) {
+            accepted = send_some(data, len);
+        }
+        accepted += tx_push(data + accepted, len - accepted);
+        this->note_output(accepted);
+        return accepted;
+    }
+
+    // Free space in the TX ring; lwIP may take more, but it cannot say how much
+    size_t writable_space() override {
+        if (!connected_ || socket_fd_ < 0) return 0;
+        drain_tx();
+        return TxBufferSize - tx_count_;
+    }
+
+    void flush() override {
+        drain_tx();
+    }
+
+    // Bytes accepted by put_bytes() but not yet handed to the socket
+    size_t pending_tx() const { return tx_count_; }
+
+    // Sleep in select() until the client sends something (or hangs up).
+    // Queued output keeps draining meanwhile; each drain restarts the timeout.
+    bool readable_wait(uint32_t timeout_ms) override {
+        if (rx_len_ > 0) return true;
+
+        while (connected_ && socket_fd_ >= 0) {
+            fd_set read_fds;
+            fd_set write_fds;
+            FD_ZERO(&read_fds);
+            FD_ZERO(&write_fds);
+            FD_SET(socket_fd_, &read_fds);
+            if (tx_count_ > 0) {
+                FD_SET(socket_fd_, &write_fds);
+            }
+
+            struct timeval tv;
+            tv.tv_sec = timeout_ms / 1000;
+            tv.tv_usec = (timeout_ms % 1000) * 1000;
+            int ready = select(socket_fd_ + 1, &read_fds, &write_fds, nullptr,
+                               (timeout_ms == mcli::WAIT_FOREVER) ? nullptr : &tv);
+            if (ready <= 0) {
+                return false;
+            }
+
+            if (FD_ISSET(socket_fd_, &read_fds)) {
+                return true;
+            }
+            drain_tx();
+        }
+        return false;
+    }
 
+    bool idle_wait(uint32_t timeout_ms) override {
+        if (!idle_modem_sleep_ || !connected_) {
+            return readable_wait(timeout_ms);
+        }
+
+        // Queued output goes out before the radio starts skipping beacons
+        drain_tx();
+        wifi_ps_type_t previous = WIFI_PS_NONE;
+        bool switched = esp_wifi_get_ps(&previous) == ESP_OK && previous != WIFI_PS_MAX_MODEM &&
+                        esp_wifi_set_ps(WIFI_PS_MAX_MODEM) == ESP_OK;
+        bool ready = readable_wait(timeout_ms);
+        if (switched) {
+            esp_wifi_set_ps(previous);
+        }
+        return ready;
+    }
+
+protected:
+    int socket_fd_;
+    bool connected_;
+    bool idle_modem_sleep_ = false;
+
+    TelnetFilter telnet_;
+
+    void send_telnet_replies() {
+        if (telnet_.reply_length() > 0) {
+            put_bytes(telnet_.replies(), telnet_.reply_length());
+            telnet_.clear_replies();
+        }
+    }
+
+private:
+    char rx_buffer_[RxBufferSize];
+    size_t rx_pos_ = 0;
+    size_t rx_len_ = 0;
+
+    char tx_buffer_[TxBufferSize];
+    size_t tx_head_ = 0;  // Oldest queued byte
+    size_t tx_count_ = 0;
+
+    // One non-blocking bulk recv with telnet commands filtered out
+    size_t receive(char* buffer, size_t max_len) {
+        int result = recv(socket_fd_, buffer, max_len, MSG_DONTWAIT);
+        if (result == 0) {
+            // Orderly shutdown from the client
+            connected_ = false;
+            return 0;
+        } else if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                connected_ = false;
+            }
+            return 0;
+        }
+
+        // Filter out telnet commands in place, answering any negotiation
+        size_t kept = telnet_.filter(buffer, static_cast<size_t>(result));
+        send_telnet_replies();
+        this->note_input(kept, static_cast<size_t>(result) - kept);
+        return kept;
+    }
+
+    // One non-blocking send; returns bytes taken (0 if the socket is full)
+    size_t send_some(const char* data, size_t len) {
+        int result = send(socket_fd_, data, len, MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ESP_LOGE("TCP", "send failed: errno=%d (%s)", errno, strerror(errno));
+                connected_ = false;
+            } else {
+                this->note_send_retry();
+            }
+            return 0;
+        }
+        if (static_cast<size_t>(result) < len) {
+            this->note_partial_send();
+        }
+        return static_cast<size_t>(result);
+    }
+
+    // Send as much of the ring as the socket will take right now
+    void drain_tx() {
+        while (tx_count_ > 0 && connected_) {
+            size_t span = TxBufferSize - tx_head_;
+            if (span > tx_count_) span = tx_count_;
+
+            size_t sent = send_some(tx_buffer_ + tx_head_, span);
+            if (sent == 0) {
+                return;
+            }
+            tx_head_ = (tx_head_ + sent) % TxBufferSize;
+            tx_count_ -= sent;
+        }
+    }
+
+    size_t tx_push(const char* data, size_t len) {
+        size_t pushed = 0;
+        while (pushed < len && tx_count_ < TxBufferSize) {
+            // Free space is contiguous up to the array end or up to the head
+            size_t tail = (tx_head_ + tx_count_) % TxBufferSize;
+            size_t span = (tail < tx_head_) ? (tx_head_ - tail) : (TxBufferSize - tail);
+            if (span > len - pushed) span = len - pushed;
+
+            memcpy(tx_buffer_ + tail, data + pushed, span);
+            tx_count_ += span;
+            pushed += span;
+        }
+        return pushed;
+    }
+
+    void wait_writable(uint32_t timeout_ms) {
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(socket_fd_, &write_fds);
+
+        struct timeval tv;
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        select(socket_fd_ + 1, nullptr, &write_fds, nullptr, &tv);
+    }
+};
+
+namespace esp32_telnet {
+    // Create a bound, listening TCP socket on port, or -1 on failure
+    inline int open_listener(int port, int backlog) {
         // Create socket
         int listen_sock = socket(AF_INET, SOCK_STREAM, 0);
         if (listen_sock < 0) {
             ESP_LOGE("TCP", "Failed to create socket");
-            return false;
+            return -1;
         }
 
         // Enable address reuse
@@ -242,67 +737,244 @@ private:
         if (setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
             ESP_LOGW("TCP", "Failed to set SO_REUSEADDR: errno=%d", errno);
         }
-        
+
         // Bind to port
         struct sockaddr_in addr = {};
         addr.sin_family = AF_INET;
-        addr.sin_port = htons(port_);
+        addr.sin_port = htons(port);
         addr.sin_addr.s_addr = INADDR_ANY;
-        
+
         if (bind(listen_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            ESP_LOGE("TCP", "Failed to bind to port %d", port_);
+            ESP_LOGE("TCP", "Failed to bind to port %d", port);
             close(listen_sock);
-            return false;
+            return -1;
         }
-        
+
         // Listen
-        if (listen(listen_sock, 1) < 0) {
+        if (listen(listen_sock, backlog) < 0) {
             ESP_LOGE("TCP", "Failed to listen");
             close(listen_sock);
+            return -1;
+        }
+
+        ESP_LOGI("TCP", "Listening on port %d", port);
+        return listen_sock;
+    }
+}
+
+/**
+ * ESP32 WiFi I/O adapter - Single client version
+ * Connects to WiFi, waits for ONE client, provides I/O interface
+ */
+class ESP32WiFiIo : public ESP32TelnetSocketIo<> {
+public:
+    ESP32WiFiIo(const char* ssid, const char* password, int port = 23)
+        : station_(ssid, password), port_(port) {}
+
+    // Connect to WiFi and wait for a client (blocking)
+    bool wait_for_client() {
+
+        ESP_LOGI("ESP32WiFiIo", "Waiting for client on port %d...", port_);
+        return accept_client();
+    }
+
+private:
+    ESP32WiFiStation station_;
+    int port_;
+
+    bool accept_client() {
+
+        // Close any exisiting socket_fd_ if open!
+        close_socket();
+
+        int listen_sock = esp32_telnet::open_listener(port_, 1);
+        if (listen_sock < 0) {
             return false;
         }
-        
-        ESP_LOGI("TCP", "Listening on port %d", port_);
-        
+
         // Accept ONE client
-        socket_fd_ = accept(listen_sock, NULL, NULL);
+        int client_fd = accept(listen_sock, NULL, NULL);
 
         // Close listening socket immediately after accepting
         close(listen_sock);
-        
-        if (socket_fd_ < 0) {
+
+        if (client_fd < 0) {
             ESP_LOGE("TCP", "Failed to accept client: errno=%d", errno);
             return false;
         }
-        
-        // Make socket non-blocking
-        int flags = fcntl(socket_fd_, F_GETFL, 0);
-        if (flags < 0) {
-            ESP_LOGE("TCP", "Failed to get socket flags: errno=%d", errno);
-            close(socket_fd_);
-            socket_fd_ = -1;
-            return false;
+
+        return attach(client_fd);
+    }
+
+};
+
+/**
+ * ESP32 multi-session telnet server
+ * One persistent listener plus up to MaxClients non-blocking client sockets,
+ * multiplexed with select() from a single task. Give each session its own
+ * CliEngine (and context, so handlers print to the right client):
+ *
+ *   ESP32TelnetServer<3> server("ssid", "password");
+ *   MyAppContext ctx0{server.client(0), ...}, ctx1{server.client(1), ...}, ctx2{server.client(2), ...};
+ *   mcli::CliEngine<MyAppContext> sessions[] = {
+ *       {server.client(0), ctx0, commands},
+ *       {server.client(1), ctx1, commands},
+ *       {server.client(2), ctx2, commands}};
+ *
+ *   while (true) {
+ *       server.poll(100);   // sleeps until a client sends data or connects
+ *       for (size_t i = 0; i < 3; i++) {
+ *           if (server.take_new_connection(i)) sessions[i].reset_session();
+ *           if (server.client(i).is_connected()) sessions[i].process_input();
+ *       }
+ *   }
+ */
+template<size_t MaxClients = 3, size_t TxBufferSize = 1024>
+class ESP32TelnetServer {
+    static_assert(MaxClients > 0, "Telnet server needs at least one client slot");
+
+public:
+    ESP32TelnetServer(const char* ssid, const char* password, int port = 23)
+        : station_(ssid, password), port_(port), listen_fd_(-1) {
+        for (size_t i = 0; i < MaxClients; i++) {
+            new_connection_[i] = false;
         }
-        if (fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            ESP_LOGE("TCP", "Failed to set non-blocking: errno=%d", errno);
-            close(socket_fd_);
-            socket_fd_ = -1;
+        begin();
+    }
+
+    ~ESP32TelnetServer() {
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+        }
+    }
+
+    // Open the persistent listener; called by the constructor, retried by poll()
+    bool begin() {
+        if (listen_fd_ >= 0) return true;
+
+        listen_fd_ = esp32_telnet::open_listener(port_, MaxClients);
+        if (listen_fd_ < 0) {
             return false;
         }
 
-        int nodelay = 1;
-        if (setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
-            ESP_LOGW("TCP", "Failed to set TCP_NODELAY: errno=%d", errno);
+        // accept() must never block the session task
+        int flags = fcntl(listen_fd_, F_GETFL, 0);
+        if (flags >= 0) {
+            fcntl(listen_fd_, F_SETFL, flags | O_NONBLOCK);
         }
+        return true;
+    }
 
-        connected_ = true;
-        ESP_LOGI("TCP", "Client connected on socket %d", socket_fd_);
+    /**
+     * Wait up to timeout_ms (or mcli::WAIT_FOREVER) for a new connection or
+     * client data, accept new clients and release slots of clients that went away.
+     * Clients with queued output also wake it once their socket is writable,
+     * and get flushed here.
+     * @return true if any socket is ready to be serviced
+     */
+    bool poll(uint32_t timeout_ms = 0) {
+        if (!begin()) return false;
+
+        // Free slots whose client disconnected since the last poll
+        for (size_t i = 0; i < MaxClients; i++) {
+            if (!clients_[i].is_connected() && clients_[i].get_client_socket() >= 0) {
+                clients_[i].close_socket();
+            }
+        }
 
-        // Do some telnet setup
-        send_telnet_response(0xFB, 0x01); // WILL echo
-        send_telnet_response(0xFB, 0x03); // WILL suppress go ahead
+        fd_set read_fds;
+        fd_set write_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(listen_fd_, &read_fds);
+        int max_fd = listen_fd_;
+        for (size_t i = 0; i < MaxClients; i++) {
+            int fd = clients_[i].get_client_socket();
+            if (fd >= 0) {
+                FD_SET(fd, &read_fds);
+                // Queued output keeps draining while the task sleeps here
+                if (clients_[i].pending_tx() > 0) {
+                    FD_SET(fd, &write_fds);
+                }
+                if (fd > max_fd) max_fd = fd;
+            }
+        }
+
+        struct timeval tv;
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        int ready = select(max_fd + 1, &read_fds, &write_fds, nullptr,
+                           (timeout_ms == mcli::WAIT_FOREVER) ? nullptr : &tv);
+        if (ready <= 0) {
+            return false;
+        }
 
+        for (size_t i = 0; i < MaxClients; i++) {
+            int fd = clients_[i].get_client_socket();
+            if (fd >= 0 && FD_ISSET(fd, &write_fds)) {
+                clients_[i].flush();
+            }
+        }
+        if (FD_ISSET(listen_fd_, &read_fds)) {
+            accept_clients();
+        }
         return true;
     }
 
-};
\ No newline at end of file
+    // I/O adapter for session slot index
+    ESP32TelnetSocketIo<TxBufferSize>& client(size_t index) { return clients_[index]; }
+
+    // True once after a client is accepted into slot index, so its session can be reset
+    bool take_new_connection(size_t index) {
+        bool is_new = new_connection_[index];
+        new_connection_[index] = false;
+        return is_new;
+    }
+
+    size_t client_count() const {
+        size_t count = 0;
+        for (size_t i = 0; i < MaxClients; i++) {
+            if (clients_[i].is_connected()) count++;
+        }
+        return count;
+    }
+
+private:
+    ESP32WiFiStation station_;
+    int port_;
+    int listen_fd_;
+    ESP32TelnetSocketIo<TxBufferSize> clients_[MaxClients];
+    bool new_connection_[MaxClients];
+
+    void accept_clients() {
+        while (true) {
+            int client_fd = accept(listen_fd_, NULL, NULL);
+            if (client_fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    ESP_LOGE("TCP", "Failed to accept client: errno=%d", errno);
+                }
+                return;
+            }
+
+            size_t slot = MaxClients;
+            for (size_t i = 0; i < MaxClients; i++) {
+                if (clients_[i].get_client_socket() < 0) {
+                    slot = i;
+                    break;
+                }
+            }
+
+            if (slot == MaxClients) {
+                static const char busy[] = "Too many sessions, try again later.\r\n";
+                send(client_fd, busy, sizeof(busy) - 1, 0);
+                close(client_fd);
+                ESP_LOGW("TCP", "Rejected client, all %u sessions in use", (unsigned)MaxClients);
+                continue;
+            }
+
+            if (clients_[slot].attach(client_fd)) {
+                new_connection_[slot] = true;
+            }
+        }
+    }
+};
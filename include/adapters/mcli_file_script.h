@@ -0,0 +1,47 @@
+// mcli_file_script.h
+// Script source reading from a stdio FILE, e.g. on a SPIFFS or LittleFS mount
+#pragma once
+
+#include <stdio.h>
+
+#include "mcli.h"
+
+/**
+ * File script source - streams a script file into CliEngine::execute_script()
+ *
+ * On ESP-IDF, SPIFFS and LittleFS are mounted into the VFS, so plain stdio
+ * works once the partition is registered:
+ *
+ *   FileScriptSource script("/spiffs/boot.cli");
+ *   if (script.is_open()) {
+ *       mcli::ScriptResult result = cli.execute_script(script);
+ *   }
+ *
+ * Only one engine line buffer of the file is in RAM at a time.
+ */
+class FileScriptSource : public mcli::ScriptSource {
+    public:
+        explicit FileScriptSource(const char* path) : file_(fopen(path, "r")), owned_(true) {}
+
+        // Read from an already open file, which stays open afterwards
+        explicit FileScriptSource(FILE* file) : file_(file), owned_(false) {}
+
+        ~FileScriptSource() override {
+            if (file_ && owned_) {
+                fclose(file_);
+            }
+        }
+
+        FileScriptSource(const FileScriptSource&) = delete;
+        FileScriptSource& operator=(const FileScriptSource&) = delete;
+
+        bool is_open() const { return file_ != nullptr; }
+
+        size_t read(char* buffer, size_t max_len) override {
+            return file_ ? fread(buffer, 1, max_len, file_) : 0;
+        }
+
+    private:
+        FILE* file_;
+        bool owned_;
+};
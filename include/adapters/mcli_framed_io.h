@@ -0,0 +1,138 @@
+// mcli_framed_io.h
+// Output framing decorator for the MCLI framed RPC mode
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * Framed I/O decorator - passes text through until the engine switches to
+ * framed mode, then wraps all output in COBS frames
+ *
+ *   ESP32UartIo uart;
+ *   FramedIo<> io(uart);
+ *   mcli::CliEngine<MyAppContext> cli(io, ctx, commands);   // ctx.io should be io too
+ *
+ * Give handlers the decorator rather than the raw adapter, or their output
+ * bypasses the framing. Output is sent in data frames of up to MaxPayload bytes,
+ * then the engine closes each request with a status frame. Input is forwarded
+ * unchanged; the engine decodes request frames itself.
+ */
+template<size_t MaxPayload = 64>
+class FramedIo final : public mcli::CliIoAdapter<FramedIo<MaxPayload>> {
+    static_assert(MaxPayload > 0 && MaxPayload + 2 <= 254, "Frames must fit in a single COBS block");
+
+    public:
+        explicit FramedIo(mcli::CliIoInterface& downstream) : downstream_(downstream) {}
+
+        void put_byte(char c) override {
+            put_bytes(&c, 1);
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            if (!framing_) {
+                downstream_.put_bytes(data, len);
+                return;
+            }
+            while (len > 0) {
+                if (used_ == MaxPayload) {
+                    send_data();
+                }
+                size_t span = MaxPayload - used_;
+                if (span > len) span = len;
+                memcpy(frame_ + 2 + used_, data, span);
+                used_ += span;
+                data += span;
+                len -= span;
+            }
+        }
+
+        char get_byte() override {
+            return downstream_.get_byte();
+        }
+
+        bool byte_available() override {
+            return downstream_.byte_available();
+        }
+
+        size_t get_bytes(char* buffer, size_t max_len) override {
+            return downstream_.get_bytes(buffer, max_len);
+        }
+
+        /**
+         * Staging into the current frame never blocks. A write that fills it
+         * sends the frame, so more than that needs room for a whole encoded frame.
+         */
+        size_t writable_space() override {
+            if (!framing_) {
+                return downstream_.writable_space();
+            }
+            if (downstream_.writable_space() >= sizeof(encoded_)) {
+                return MaxPayload;
+            }
+            return MaxPayload - used_;
+        }
+
+        bool readable_wait(uint32_t timeout_ms) override {
+            return downstream_.readable_wait(timeout_ms);
+        }
+
+        bool idle_wait(uint32_t timeout_ms) override {
+            return downstream_.idle_wait(timeout_ms);
+        }
+
+        void flush() override {
+            // Staged output waits for framing_end() so the reply keeps its order
+            downstream_.flush();
+        }
+
+        bool set_framing(bool enabled) override {
+            framing_ = enabled;
+            used_ = 0;
+            return true;
+        }
+
+        void framing_begin(uint8_t seq) override {
+            seq_ = seq;
+            used_ = 0;
+        }
+
+        void framing_end(mcli::FrameStatus status) override {
+            if (used_ > 0) {
+                send_data();
+            }
+            frame_[2] = static_cast<uint8_t>(status);
+            send_frame(mcli::FRAME_STATUS, 1);
+        }
+
+        bool framing() const { return framing_; }
+
+#ifdef MCLI_ENABLE_STATS
+        // Counters belong to the link, not the framing
+        mcli::IoStats& io_stats() override {
+            return downstream_.io_stats();
+        }
+#endif
+
+    private:
+        mcli::CliIoInterface& downstream_;
+        bool framing_ = false;
+        uint8_t seq_ = 0;
+
+        // [seq][type][payload], encoded into encoded_ when sent
+        uint8_t frame_[MaxPayload + 2];
+        size_t used_ = 0;
+        uint8_t encoded_[MaxPayload + 5]; // COBS adds up to two code bytes, plus the delimiter
+
+        void send_data() {
+            send_frame(mcli::FRAME_DATA, used_);
+            used_ = 0;
+        }
+
+        void send_frame(uint8_t type, size_t payload_len) {
+            frame_[0] = seq_;
+            frame_[1] = type;
+            size_t len = mcli::cobs_encode(frame_, payload_len + 2, encoded_);
+            encoded_[len++] = 0x00;
+            downstream_.put_bytes(reinterpret_cast<const char*>(encoded_), len);
+        }
+};
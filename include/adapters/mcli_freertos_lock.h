@@ -0,0 +1,56 @@
+// mcli_freertos_lock.h
+// FreeRTOS recursive mutex as the context lock for MCLI sessions in separate tasks
+#pragma once
+
+#include "mcli.h"
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+#include "FreeRTOS.h"
+#include "semphr.h"
+#endif
+
+
+/**
+ * Context lock shared by the sessions that reach the same state, one per
+ * task. The mutex is recursive, so a handler that runs a command or script
+ * itself does not deadlock, and priority inheritance keeps a low-priority
+ * console from holding up a higher-priority one past its own handler.
+ * Needs configUSE_RECURSIVE_MUTEXES; works on any FreeRTOS port.
+ *
+ *   FreeRtosContextLock lock;
+ *   uart_cli.set_context_lock(&lock);
+ *   wifi_cli.set_context_lock(&lock);
+ */
+class FreeRtosContextLock final : public mcli::ContextLock {
+    public:
+        FreeRtosContextLock() : mutex_(xSemaphoreCreateRecursiveMutex()) {}
+
+        ~FreeRtosContextLock() override {
+            if (mutex_) {
+                vSemaphoreDelete(mutex_);
+            }
+        }
+
+        void lock() override {
+            if (mutex_) {
+                xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+            }
+        }
+
+        void unlock() override {
+            if (mutex_) {
+                xSemaphoreGiveRecursive(mutex_);
+            }
+        }
+
+        // False if the mutex could not be created (out of heap); handlers then run unlocked
+        bool valid() const { return mutex_ != nullptr; }
+
+    private:
+        SemaphoreHandle_t mutex_;
+
+        FreeRtosContextLock(const FreeRtosContextLock&) = delete;
+        FreeRtosContextLock& operator=(const FreeRtosContextLock&) = delete;
+};
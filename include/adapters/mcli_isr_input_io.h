@@ -0,0 +1,72 @@
+// mcli_isr_input_io.h
+// Base adapter for links whose received bytes arrive in an interrupt handler
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * Interrupt-fed input base - the RX interrupt pushes bytes into a lock-free
+ * ring and the engine drains it with bulk copies from the main loop
+ *
+ * Derive from it (passing the adapter itself as Derived, see CliIoAdapter)
+ * and implement put_byte(), plus put_bytes() if the link has a bulk path,
+ * for the transmit side:
+ *
+ *   class MyUartIo final : public IsrInputIo<MyUartIo, 256> {
+ *       public:
+ *           void put_byte(char c) override { while (UART->STAT & TX_FULL) {} UART->TX = c; }
+ *   };
+ *   MyUartIo uart;
+ *   extern "C" void UART_IRQHandler() { uart.receive_from_isr(UART->RX); }
+ *
+ * receive_from_isr() must only be called from one context (the ISR); all the
+ * CliIoInterface methods belong to the main loop. Bytes that arrive while the
+ * ring is full are dropped and counted (overflow_count(), and dropped_in in
+ * the link counters).
+ */
+template<typename Derived, size_t RxCapacity = 128>
+class IsrInputIo : public mcli::CliIoAdapter<Derived> {
+    public:
+        // Producer side, for the RX interrupt
+        bool receive_from_isr(char c) {
+            return rx_.push(c);
+        }
+
+        size_t receive_from_isr(const char* data, size_t len) {
+            return rx_.push(data, len);
+        }
+
+        char get_byte() override {
+            char c = 0;
+            if (rx_.pop(c)) {
+                this->note_input(1, take_overflows());
+            }
+            return c;
+        }
+
+        bool byte_available() override {
+            return !rx_.empty();
+        }
+
+        size_t get_bytes(char* buffer, size_t max_len) override {
+            size_t count = rx_.pop(buffer, max_len);
+            this->note_input(count, take_overflows());
+            return count;
+        }
+
+        // Bytes lost because the ring was full
+        uint32_t overflow_count() const { return rx_.dropped(); }
+
+    protected:
+        mcli::SpscRing<RxCapacity> rx_;
+
+    private:
+        uint32_t overflows_seen_ = 0;
+
+        size_t take_overflows() {
+            uint32_t overflows = rx_.dropped();
+            size_t fresh = overflows - overflows_seen_;
+            overflows_seen_ = overflows;
+            return fresh;
+        }
+};
@@ -0,0 +1,101 @@
+// mcli_memory_loopback.h
+// In-memory I/O adapter for MCLI host builds, tests and benchmarks
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * Memory loopback adapter - input comes from a caller-owned buffer and output
+ * is captured in RAM
+ *
+ *   MemoryLoopbackIo<512> io;
+ *   mcli::CliEngine<MyAppContext> cli(io, ctx, commands);
+ *   io.set_input("led on\r");
+ *   cli.process_input();
+ *   puts(io.output());
+ *
+ * Input is not copied, so the buffer passed to set_input() must outlive the
+ * reads. Output beyond OutputSize is counted but not kept; OutputSize 0
+ * discards everything, which keeps capture cost out of benchmarks.
+ */
+template<size_t OutputSize = 256>
+class MemoryLoopbackIo final : public mcli::CliIoAdapter<MemoryLoopbackIo<OutputSize>> {
+    public:
+        MemoryLoopbackIo() {
+            output_[0] = '\0';
+        }
+
+        // Serve data (len bytes) to the next reads
+        void set_input(const char* data, size_t len) {
+            input_ = data;
+            input_len_ = len;
+            input_pos_ = 0;
+        }
+
+        void set_input(const char* str) {
+            set_input(str, str ? strlen(str) : 0);
+        }
+
+        size_t input_remaining() const { return input_len_ - input_pos_; }
+
+        // Captured output, NUL-terminated
+        const char* output() const { return output_; }
+        size_t output_length() const { return output_len_; }
+
+        // Bytes written since the last clear_output(), including any not kept
+        size_t output_total() const { return output_total_; }
+
+        void clear_output() {
+            output_len_ = 0;
+            output_total_ = 0;
+            output_[0] = '\0';
+        }
+
+        void put_byte(char c) override {
+            put_bytes(&c, 1);
+        }
+
+        char get_byte() override {
+            if (input_pos_ >= input_len_) return 0;
+            this->note_input(1);
+            return input_[input_pos_++];
+        }
+
+        bool byte_available() override {
+            return input_pos_ < input_len_;
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            size_t room = OutputSize - output_len_;
+            size_t kept = (len < room) ? len : room;
+            memcpy(output_ + output_len_, data, kept);
+            output_len_ += kept;
+            output_[output_len_] = '\0';
+            output_total_ += len;
+            this->note_output(len);
+        }
+
+        size_t get_bytes(char* buffer, size_t max_len) override {
+            size_t count = input_remaining();
+            if (count > max_len) count = max_len;
+            memcpy(buffer, input_ + input_pos_, count);
+            input_pos_ += count;
+            this->note_input(count);
+            return count;
+        }
+
+        // Nothing will ever arrive beyond what set_input() provided
+        bool readable_wait(uint32_t timeout_ms) override {
+            (void)timeout_ms;
+            return byte_available();
+        }
+
+    private:
+        const char* input_ = nullptr;
+        size_t input_len_ = 0;
+        size_t input_pos_ = 0;
+
+        char output_[OutputSize + 1];
+        size_t output_len_ = 0;
+        size_t output_total_ = 0;
+};
@@ -0,0 +1,127 @@
+// mcli_ram_log.h
+// Output-only sink keeping the most recent console output in a RAM ring
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * RAM log sink - keeps the last Size bytes written to it, overwriting the
+ * oldest. Mirror a console into it with TeeIo and dump it after a crash.
+ *
+ * Placed in memory the startup code leaves alone and constructed with
+ * RAM_LOG_RESTORE, it survives a software reset: that constructor keeps the
+ * contents when its header checks out. The default constructor always
+ * starts empty.
+ *
+ *   RTC_NOINIT_ATTR RamLogSink<2048> ram_log(RAM_LOG_RESTORE);       // ESP32
+ *   // __attribute__((section(".noinit"))) RamLogSink<512> ram_log(RAM_LOG_RESTORE);   // AVR
+ *
+ *   if (ram_log.restored()) {
+ *       ram_log.dump(uart);    // Output leading up to the reset
+ *       ram_log.clear();
+ *   }
+ *
+ * Writes never block and never fail, and there is no input.
+ */
+struct RamLogRestore {};
+
+// Constructor tag for a RamLogSink in no-init memory: keep what was there
+constexpr RamLogRestore RAM_LOG_RESTORE{};
+
+template<size_t Size = 1024>
+class RamLogSink final : public mcli::CliIoAdapter<RamLogSink<Size>> {
+    static_assert(Size > 0, "RamLogSink needs a non-empty ring");
+
+    public:
+        RamLogSink() : magic_(0), check_(0), head_(0), count_(0), data_(), restored_(false) {
+            clear();
+        }
+
+        /**
+         * Only for an instance in no-init memory, whose members the startup
+         * code left as they were before the reset. Anywhere else they are
+         * indeterminate, so use the default constructor.
+         */
+        explicit RamLogSink(RamLogRestore) {
+            restored_ = (magic_ == MAGIC && head_ < Size && count_ <= Size && check_ == checksum());
+            if (!restored_) {
+                clear();
+            }
+        }
+
+        void clear() {
+            head_ = 0;
+            count_ = 0;
+            magic_ = MAGIC;
+            check_ = checksum();
+        }
+
+        // True if the constructor found contents from before a reset
+        bool restored() const { return restored_; }
+
+        // Bytes held, up to Size
+        size_t length() const { return count_; }
+
+        /**
+         * Copy the held bytes, oldest first, into out (not NUL-terminated)
+         * @return Bytes copied
+         */
+        size_t copy_to(char* out, size_t max_len) const {
+            size_t len = (count_ < max_len) ? count_ : max_len;
+            size_t skip = count_ - len; // Keep the newest bytes if out is small
+            size_t start = (head_ + Size - count_ + skip) % Size;
+            size_t first = Size - start;
+            if (first > len) first = len;
+            memcpy(out, data_ + start, first);
+            memcpy(out + first, data_, len - first);
+            return len;
+        }
+
+        // Write the held bytes, oldest first, to another adapter
+        void dump(mcli::CliIoInterface& out) const {
+            size_t start = (head_ + Size - count_) % Size;
+            size_t first = Size - start;
+            if (first > count_) first = count_;
+            if (first > 0) out.put_bytes(data_ + start, first);
+            if (count_ > first) out.put_bytes(data_, count_ - first);
+            out.flush();
+        }
+
+        void put_byte(char c) override {
+            put_bytes(&c, 1);
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            if (len >= Size) {
+                // Only the tail survives
+                data += len - Size;
+                len = Size;
+            }
+            size_t first = Size - head_;
+            if (first > len) first = len;
+            memcpy(data_ + head_, data, first);
+            memcpy(data_, data + first, len - first);
+            head_ = (head_ + len) % Size;
+            count_ = (count_ + len > Size) ? Size : count_ + len;
+            check_ = checksum();
+            this->note_output(len);
+        }
+
+        char get_byte() override { return 0; }
+        bool byte_available() override { return false; }
+
+    private:
+        static constexpr uint32_t MAGIC = 0x6D6C6F67; // "mlog"
+
+        // Guards the header; the data itself is not checked
+        uint32_t checksum() const {
+            return MAGIC ^ (static_cast<uint32_t>(head_) * 2654435761u) ^ static_cast<uint32_t>(count_);
+        }
+
+        uint32_t magic_;
+        uint32_t check_;
+        size_t head_;  // Next write position
+        size_t count_;
+        char data_[Size];
+        bool restored_;
+};
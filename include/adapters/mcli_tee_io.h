@@ -0,0 +1,136 @@
+// mcli_tee_io.h
+// Output fan-out decorator: one console, any number of mirror sinks
+#pragma once
+
+#include "mcli.h"
+
+/**
+ * Tee I/O decorator - sends every output chunk to the primary adapter and to
+ * up to MaxMirrors mirror sinks, e.g. a RAM log kept for crash dumps
+ *
+ *   ESP32UartIo uart;
+ *   RamLogSink<2048> ram_log;
+ *   TeeIo<> tee(uart);
+ *   tee.add_mirror(ram_log);
+ *   mcli::CliEngine<MyAppContext> cli(tee, ctx, commands);   // ctx.io should be tee too
+ *
+ * Output is formatted once; each chunk the formatter (or a BufferedIo in
+ * front of the tee) produces is handed to every sink. Mirrors are written
+ * with try_put_bytes() before the primary, so a backed-up mirror loses
+ * output (see mirror_dropped()) rather than stalling the console, and a
+ * slow console never holds up the mirrors. Input, framing and link counters
+ * come from the primary only.
+ */
+template<size_t MaxMirrors = 2>
+class TeeIo final : public mcli::CliIoAdapter<TeeIo<MaxMirrors>> {
+    static_assert(MaxMirrors > 0, "TeeIo needs room for at least one mirror");
+
+    public:
+        explicit TeeIo(mcli::CliIoInterface& primary) : primary_(primary) {}
+
+        // @return false if all MaxMirrors slots are taken
+        bool add_mirror(mcli::CliIoInterface& mirror) {
+            if (mirror_count_ == MaxMirrors) return false;
+            mirrors_[mirror_count_] = &mirror;
+            dropped_[mirror_count_] = 0;
+            mirror_count_++;
+            return true;
+        }
+
+        void remove_mirror(mcli::CliIoInterface& mirror) {
+            for (size_t i = 0; i < mirror_count_; i++) {
+                if (mirrors_[i] == &mirror) {
+                    mirror_count_--;
+                    mirrors_[i] = mirrors_[mirror_count_];
+                    dropped_[i] = dropped_[mirror_count_];
+                    return;
+                }
+            }
+        }
+
+        size_t mirror_count() const { return mirror_count_; }
+
+        // Bytes mirror i could not take without blocking
+        size_t mirror_dropped(size_t i) const { return i < mirror_count_ ? dropped_[i] : 0; }
+
+        void put_byte(char c) override {
+            put_bytes(&c, 1);
+        }
+
+        void put_bytes(const char* data, size_t len) override {
+            write_mirrors(data, len);
+            primary_.put_bytes(data, len);
+        }
+
+        // Mirrors never block, so only the primary limits the space
+        size_t writable_space() override {
+            return primary_.writable_space();
+        }
+
+        size_t try_put_bytes(const char* data, size_t len) override {
+            size_t accepted = primary_.try_put_bytes(data, len);
+            write_mirrors(data, accepted);
+            return accepted;
+        }
+
+        char get_byte() override {
+            return primary_.get_byte();
+        }
+
+        bool byte_available() override {
+            return primary_.byte_available();
+        }
+
+        size_t get_bytes(char* buffer, size_t max_len) override {
+            return primary_.get_bytes(buffer, max_len);
+        }
+
+        bool readable_wait(uint32_t timeout_ms) override {
+            return primary_.readable_wait(timeout_ms);
+        }
+
+        // Only the primary link powers down
+        bool idle_wait(uint32_t timeout_ms) override {
+            return primary_.idle_wait(timeout_ms);
+        }
+
+        void flush() override {
+            for (size_t i = 0; i < mirror_count_; i++) {
+                mirrors_[i]->flush();
+            }
+            primary_.flush();
+        }
+
+        // Only the primary frames; mirrors keep logging the plain output
+        bool set_framing(bool enabled) override {
+            return primary_.set_framing(enabled);
+        }
+
+        void framing_begin(uint8_t seq) override {
+            primary_.framing_begin(seq);
+        }
+
+        void framing_end(mcli::FrameStatus status) override {
+            primary_.framing_end(status);
+        }
+
+#ifdef MCLI_ENABLE_STATS
+        // Counters belong to the console link
+        mcli::IoStats& io_stats() override {
+            return primary_.io_stats();
+        }
+#endif
+
+    private:
+        mcli::CliIoInterface& primary_;
+        mcli::CliIoInterface* mirrors_[MaxMirrors];
+        size_t dropped_[MaxMirrors];
+        size_t mirror_count_ = 0;
+
+        void write_mirrors(const char* data, size_t len) {
+            if (len == 0) return;
+            for (size_t i = 0; i < mirror_count_; i++) {
+                dropped_[i] += len - mirrors_[i]->try_put_bytes(data, len);
+            }
+        }
+};
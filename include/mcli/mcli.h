@@ -5,6 +5,8 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
  
 namespace mcli {
 
@@ -17,33 +19,969 @@ namespace mcli {
     constexpr int MAX_ARG_LENGTH = 12;
     constexpr size_t CMD_BUFFER_SIZE = 128;
     constexpr const char* DEFAULT_PROMPT = "\x1b[1mmcli> \x1b[0m";
+    constexpr size_t BATCH_READ_LIMIT = 512; // Max bytes consumed per process_input() in batch mode
+    constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFFu; // readable_wait() timeout that never expires
+    constexpr size_t WRITE_SPACE_UNLIMITED = static_cast<size_t>(-1); // writable_space() of links that never push back
 
     // Calculate total CommandArgs memory usage at compile time
     constexpr size_t COMMAND_ARGS_SIZE = sizeof(int) + (MAX_ARGS * MAX_ARG_LENGTH);
-    static_assert(COMMAND_ARGS_SIZE <= 300, "CommandArgs too large for constrained systems");
 
-    // Command argument structure
-    struct CommandArgs {
+    // Command argument structure, sized per engine instance
+    template<int MaxArgs = MAX_ARGS, int MaxArgLength = MAX_ARG_LENGTH>
+    struct BasicCommandArgs {
+        static constexpr size_t SIZE = sizeof(int) + (MaxArgs * MaxArgLength);
+        static_assert(MaxArgs > 0 && MaxArgLength > 1, "CommandArgs needs room for at least one argument");
+        static_assert(SIZE <= 300, "CommandArgs too large for constrained systems");
+
         int argc;
-        char argv[MAX_ARGS][MAX_ARG_LENGTH];
+        char argv[MaxArgs][MaxArgLength];
 
-        CommandArgs() : argc(0) {
+        BasicCommandArgs() : argc(0) {
             memset(argv, 0, sizeof(argv));
         }
     };
 
+    using CommandArgs = BasicCommandArgs<>;
+
+    /**
+     * Zero-copy command arguments. The line is tokenized in place, so each argv
+     * entry is a NUL-terminated token inside the engine's input buffer and is only
+     * valid for the duration of the handler call. argv[argc] is nullptr.
+     */
+    struct CommandArgsView {
+        int argc;
+        const char* const* argv;
+        const size_t* lengths;
+
+        const char* operator[](int index) const {
+            return (index >= 0 && index < argc) ? argv[index] : nullptr;
+        }
+    };
+
     // Generic command function signature
+    template<typename ContextType, typename ArgsType = CommandArgs>
+    using CommandFunction = void(*)(const ArgsType args, ContextType* ctx);
+
+    // Command function signature taking zero-copy arguments
     template<typename ContextType>
-    using CommandFunction = void(*)(const CommandArgs args, ContextType* ctx);
+    using CommandViewFunction = void(*)(const CommandArgsView& args, ContextType* ctx);
 
-    // Command definition structure
+    // Why a typed command rejected its arguments (filled in by the parsing thunk)
+    struct TypedArgsError {
+        int index;                // 1-based argument that failed to parse, 0 for a wrong count
+        const char* const* types; // Expected type names, one per parameter
+        int type_count;
+    };
+
+    // Parse-and-call thunk generated by MCLI_TYPED(); returns false on a usage error
+    template<typename ContextType>
+    using CommandTypedFunction = bool(*)(const CommandArgsView& args, ContextType* ctx, TypedArgsError& error);
+
+    // What a resumable command step asks the engine to do next
+    enum class StepResult : uint8_t {
+        Continue, // Call again on a later slice
+        Done,     // Finished, show the prompt
+    };
+
+    // Per-run state handed to every step of a resumable command
+    struct CommandTask {
+        uint32_t step;   // Number of earlier steps in this run (0 on the first call)
+        uintptr_t state; // Free for the handler (cursor, address, ...); starts at 0
+        bool cancelled;  // Set on the final call after Ctrl-C; the return value is ignored
+    };
+
+    // Resumable command: does a bounded amount of work per call
     template<typename ContextType>
+    using CommandStepFunction = StepResult(*)(const CommandArgsView& args, ContextType* ctx, CommandTask& task);
+
+    // Handler flavor stored in a CommandDefinition
+    enum class CommandKind : uint8_t {
+        Args,
+        View,
+        Typed,
+        Step,
+        Group,
+    };
+
+    // CommandDefinition flags
+    constexpr uint8_t CMD_REENTRANT = 0x01; // Safe to run in parallel: never takes the session's context lock
+
+    // Command definition structure
+    template<typename ContextType, typename ArgsType = CommandArgs>
     struct CommandDefinition {
         const char* name;
-        CommandFunction<ContextType> execute;
+        union {
+            CommandFunction<ContextType, ArgsType> execute;
+            CommandViewFunction<ContextType> execute_view;
+            CommandTypedFunction<ContextType> execute_typed;
+            CommandStepFunction<ContextType> execute_step;
+            const CommandDefinition* children;
+        };
         const char* help;
+        CommandKind kind;
+        uint8_t flags;
+        uint16_t child_count;
+
+        constexpr CommandDefinition(const char* name, CommandFunction<ContextType, ArgsType> execute, const char* help, uint8_t flags = 0)
+            : name(name), execute(execute), help(help), kind(CommandKind::Args), flags(flags), child_count(0) {}
+
+        constexpr CommandDefinition(const char* name, CommandViewFunction<ContextType> execute_view, const char* help, uint8_t flags = 0)
+            : name(name), execute_view(execute_view), help(help), kind(CommandKind::View), flags(flags), child_count(0) {}
+
+        constexpr CommandDefinition(const char* name, CommandTypedFunction<ContextType> execute_typed, const char* help, uint8_t flags = 0)
+            : name(name), execute_typed(execute_typed), help(help), kind(CommandKind::Typed), flags(flags), child_count(0) {}
+
+        constexpr CommandDefinition(const char* name, CommandStepFunction<ContextType> execute_step, const char* help, uint8_t flags = 0)
+            : name(name), execute_step(execute_step), help(help), kind(CommandKind::Step), flags(flags), child_count(0) {}
+
+        /**
+         * Command group: the next argument selects an entry of the child table.
+         *   const mcli::CommandDefinition<Ctx> wifi_commands[] = { {"status", wifi_status, "..."} };
+         *   const mcli::CommandDefinition<Ctx> net_commands[] = { {"wifi", wifi_commands, "WiFi commands"} };
+         */
+        template<size_t N>
+        constexpr CommandDefinition(const char* name, const CommandDefinition (&children)[N], const char* help)
+            : name(name), children(children), help(help), kind(CommandKind::Group), flags(0),
+              child_count(static_cast<uint16_t>(N)) {
+            static_assert(N <= 0xFFFF, "Command group has too many entries");
+        }
+    };
+
+    // =============================================================================
+    // TOKENIZER
+    // =============================================================================
+
+    /**
+     * Index of the first '\r' or '\n' in data, or len if there is none.
+     * Tests four bytes per step for either terminator before falling back to
+     * a byte scan to pin down the exact position.
+     */
+    inline size_t find_line_end(const char* data, size_t len) {
+        const uint32_t ones = 0x01010101u;
+        const uint32_t highs = 0x80808080u;
+
+        size_t i = 0;
+        for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+            uint32_t word;
+            memcpy(&word, data + i, sizeof(word));
+            uint32_t cr = word ^ 0x0D0D0D0Du;
+            uint32_t lf = word ^ 0x0A0A0A0Au;
+            if (((cr - ones) & ~cr & highs) | ((lf - ones) & ~lf & highs)) {
+                break;
+            }
+        }
+        for (; i < len; i++) {
+            if (data[i] == '\r' || data[i] == '\n') {
+                return i;
+            }
+        }
+        return len;
+    }
+
+    /**
+     * Split a line into arguments in place by NUL-terminating the separators.
+     * Tokens past max_args are ignored; overflow, if given, tells whether there
+     * were any. argv must hold max_args + 1 entries.
+     * @return Number of tokens kept
+     */
+    inline int tokenize_in_place(char* line, const char** argv, size_t* lengths, int max_args,
+                                 bool* overflow = nullptr) {
+        int argc = 0;
+        char* cursor = line;
+        while (*cursor && argc < max_args) {
+            // Skip leading spaces
+            while (*cursor == ' ') cursor++;
+            if (!*cursor) break;
+
+            char* start = cursor;
+            while (*cursor && *cursor != ' ') cursor++;
+
+            argv[argc] = start;
+            lengths[argc] = static_cast<size_t>(cursor - start);
+            argc++;
+
+            if (*cursor) {
+                *cursor++ = '\0';
+            }
+        }
+        if (overflow) {
+            while (*cursor == ' ') cursor++;
+            *overflow = (*cursor != '\0');
+        }
+        argv[argc] = nullptr;
+        return argc;
+    }
+
+    // =============================================================================
+    // TYPED ARGUMENTS
+    // =============================================================================
+
+    /**
+     * Converts one argument token into a handler parameter. Specializations exist
+     * for the built-in integer types, float, double, bool and const char*; enums
+     * are added with MCLI_ENUM_ARG(). Each provides a type name for usage messages
+     * and a parse() that rejects malformed or out-of-range input.
+     */
+    template<typename T>
+    struct ArgParser;
+
+    namespace detail {
+        // Decimal, or hex with a 0x prefix. No locale, no errno, no strtol.
+        template<typename UnsignedType>
+        bool parse_magnitude(const char* text, UnsignedType limit, UnsignedType& out) {
+            unsigned base = 10;
+            if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+                base = 16;
+                text += 2;
+            }
+            if (!*text) return false;
+
+            UnsignedType value = 0;
+            for (; *text; text++) {
+                unsigned digit;
+                char c = *text;
+                if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+                else if (base == 16 && c >= 'a' && c <= 'f') digit = static_cast<unsigned>(c - 'a' + 10);
+                else if (base == 16 && c >= 'A' && c <= 'F') digit = static_cast<unsigned>(c - 'A' + 10);
+                else return false;
+
+                if (value > (limit - digit) / base) return false;
+                value = static_cast<UnsignedType>(value * base + digit);
+            }
+            out = value;
+            return true;
+        }
+
+        template<typename T, typename UnsignedType>
+        bool parse_signed(const char* text, T min, T max, T& out) {
+            bool negative = (*text == '-');
+            if (*text == '-' || *text == '+') text++;
+
+            UnsignedType limit = negative
+                ? static_cast<UnsignedType>(0 - static_cast<UnsignedType>(min))
+                : static_cast<UnsignedType>(max);
+            UnsignedType magnitude;
+            if (!parse_magnitude(text, limit, magnitude)) return false;
+
+            if (negative && magnitude > 0) {
+                // Negate without overflowing when the result is the type's minimum
+                out = static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+            } else {
+                out = static_cast<T>(magnitude);
+            }
+            return true;
+        }
+
+        template<typename T, typename UnsignedType>
+        bool parse_unsigned(const char* text, T max, T& out) {
+            if (*text == '+') text++;
+            UnsignedType magnitude;
+            if (!parse_magnitude(text, static_cast<UnsignedType>(max), magnitude)) return false;
+            out = static_cast<T>(magnitude);
+            return true;
+        }
+
+        template<typename EnumType>
+        bool parse_enum(const char* text, const char* const* names, size_t count, EnumType& out) {
+            for (size_t i = 0; i < count; i++) {
+                if (strcmp(text, names[i]) == 0) {
+                    out = static_cast<EnumType>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<size_t... Indices>
+        struct index_sequence {};
+
+        template<size_t N, size_t... Indices>
+        struct make_index_sequence : make_index_sequence<N - 1, N - 1, Indices...> {};
+
+        template<size_t... Indices>
+        struct make_index_sequence<0, Indices...> {
+            using type = index_sequence<Indices...>;
+        };
+
+        // Minimal tuple holding the parsed parameter values
+        template<size_t Index, typename T>
+        struct ArgSlot {
+            T value;
+        };
+
+        template<typename Sequence, typename... Params>
+        struct ArgSlots;
+
+        template<size_t... Indices, typename... Params>
+        struct ArgSlots<index_sequence<Indices...>, Params...> : ArgSlot<Indices, Params>... {};
+    }
+
+#define MCLI_SIGNED_ARG(Type, Unsigned, Min, Max)                                    \
+    template<> struct ArgParser<Type> {                                              \
+        static constexpr const char* name = "int";                                   \
+        static bool parse(const char* text, Type& value) {                           \
+            return detail::parse_signed<Type, Unsigned>(text, Min, Max, value);      \
+        }                                                                            \
+    };
+#define MCLI_UNSIGNED_ARG(Type, Unsigned, Max)                                       \
+    template<> struct ArgParser<Type> {                                              \
+        static constexpr const char* name = "uint";                                  \
+        static bool parse(const char* text, Type& value) {                           \
+            return detail::parse_unsigned<Type, Unsigned>(text, Max, value);         \
+        }                                                                            \
+    };
+
+    MCLI_SIGNED_ARG(signed char, unsigned long, SCHAR_MIN, SCHAR_MAX)
+    MCLI_SIGNED_ARG(short, unsigned long, SHRT_MIN, SHRT_MAX)
+    MCLI_SIGNED_ARG(int, unsigned long, INT_MIN, INT_MAX)
+    MCLI_SIGNED_ARG(long, unsigned long, LONG_MIN, LONG_MAX)
+    MCLI_SIGNED_ARG(long long, unsigned long long, LLONG_MIN, LLONG_MAX)
+    MCLI_UNSIGNED_ARG(unsigned char, unsigned long, UCHAR_MAX)
+    MCLI_UNSIGNED_ARG(unsigned short, unsigned long, USHRT_MAX)
+    MCLI_UNSIGNED_ARG(unsigned int, unsigned long, UINT_MAX)
+    MCLI_UNSIGNED_ARG(unsigned long, unsigned long, ULONG_MAX)
+    MCLI_UNSIGNED_ARG(unsigned long long, unsigned long long, ULLONG_MAX)
+
+#undef MCLI_SIGNED_ARG
+#undef MCLI_UNSIGNED_ARG
+
+    template<> struct ArgParser<double> {
+        static constexpr const char* name = "float";
+        static bool parse(const char* text, double& value) {
+            char* end = nullptr;
+            value = strtod(text, &end);
+            return end != text && *end == '\0';
+        }
+    };
+
+    template<> struct ArgParser<float> {
+        static constexpr const char* name = "float";
+        static bool parse(const char* text, float& value) {
+            double parsed;
+            if (!ArgParser<double>::parse(text, parsed)) return false;
+            value = static_cast<float>(parsed);
+            return true;
+        }
+    };
+
+    template<> struct ArgParser<bool> {
+        static constexpr const char* name = "on|off";
+        static bool parse(const char* text, bool& value) {
+            static const char* const names[] = {"0", "1", "off", "on", "false", "true", "no", "yes"};
+            size_t index = 0;
+            if (!detail::parse_enum(text, names, sizeof(names) / sizeof(names[0]), index)) return false;
+            value = (index & 1) != 0;
+            return true;
+        }
+    };
+
+    template<> struct ArgParser<const char*> {
+        static constexpr const char* name = "string";
+        static bool parse(const char* text, const char*& value) {
+            value = text;
+            return true;
+        }
+    };
+
+// Join up to 16 string literals with '|' at compile time ("off" "|" "on" ...)
+#define MCLI_DETAIL_JOIN_1(a) a
+#define MCLI_DETAIL_JOIN_2(a, ...) a "|" MCLI_DETAIL_JOIN_1(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_3(a, ...) a "|" MCLI_DETAIL_JOIN_2(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_4(a, ...) a "|" MCLI_DETAIL_JOIN_3(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_5(a, ...) a "|" MCLI_DETAIL_JOIN_4(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_6(a, ...) a "|" MCLI_DETAIL_JOIN_5(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_7(a, ...) a "|" MCLI_DETAIL_JOIN_6(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_8(a, ...) a "|" MCLI_DETAIL_JOIN_7(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_9(a, ...) a "|" MCLI_DETAIL_JOIN_8(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_10(a, ...) a "|" MCLI_DETAIL_JOIN_9(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_11(a, ...) a "|" MCLI_DETAIL_JOIN_10(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_12(a, ...) a "|" MCLI_DETAIL_JOIN_11(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_13(a, ...) a "|" MCLI_DETAIL_JOIN_12(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_14(a, ...) a "|" MCLI_DETAIL_JOIN_13(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_15(a, ...) a "|" MCLI_DETAIL_JOIN_14(__VA_ARGS__)
+#define MCLI_DETAIL_JOIN_16(a, ...) a "|" MCLI_DETAIL_JOIN_15(__VA_ARGS__)
+#define MCLI_DETAIL_COUNT(...) \
+    MCLI_DETAIL_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MCLI_DETAIL_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define MCLI_DETAIL_CAT(a, b) MCLI_DETAIL_CAT_(a, b)
+#define MCLI_DETAIL_CAT_(a, b) a##b
+#define MCLI_DETAIL_JOIN(...) MCLI_DETAIL_CAT(MCLI_DETAIL_JOIN_, MCLI_DETAIL_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+/**
+ * Let an enum be used as a typed command parameter. Tokens are matched against
+ * the names in order, so the first name maps to enumerator value 0. Usage
+ * messages list the names, like "on|off" for bool:
+ *
+ *   enum class LedMode { Off, On, Blink };
+ *   MCLI_ENUM_ARG(LedMode, "off", "on", "blink")   // Usage: led <uint> <off|on|blink>
+ *
+ * Takes 1 to 16 names, as string literals. Must be used at global scope.
+ */
+#define MCLI_ENUM_ARG(EnumType, ...)                                                 \
+    namespace mcli {                                                                 \
+        template<> struct ArgParser<EnumType> {                                      \
+            static constexpr const char* name = MCLI_DETAIL_JOIN(__VA_ARGS__);       \
+            static bool parse(const char* text, EnumType& value) {                   \
+                static const char* const names[] = {__VA_ARGS__};                    \
+                return detail::parse_enum(text, names, sizeof(names) / sizeof(names[0]), value); \
+            }                                                                        \
+        };                                                                           \
+    }
+
+    /**
+     * Generates the parse-and-call thunk for a typed handler. Use MCLI_TYPED()
+     * rather than naming this directly.
+     */
+    template<typename Signature, Signature Handler>
+    struct TypedCommand;
+
+    template<typename ContextType, typename... Params, void (*Handler)(ContextType*, Params...)>
+    struct TypedCommand<void (*)(ContextType*, Params...), Handler> {
+        using Sequence = typename detail::make_index_sequence<sizeof...(Params)>::type;
+        using Slots = detail::ArgSlots<Sequence, Params...>;
+
+        static bool invoke(const CommandArgsView& args, ContextType* ctx, TypedArgsError& error) {
+            static const char* const types[] = {ArgParser<Params>::name..., nullptr};
+            error.index = 0;
+            error.types = types;
+            error.type_count = static_cast<int>(sizeof...(Params));
+
+            if (args.argc - 1 != static_cast<int>(sizeof...(Params))) {
+                return false;
+            }
+            return call(args, ctx, error, Sequence());
+        }
+
+    private:
+        template<size_t Index, typename T>
+        static bool parse_one(Slots& slots, const CommandArgsView& args, TypedArgsError& error) {
+            if (error.index != 0) return false;
+            if (!ArgParser<T>::parse(args.argv[Index + 1], static_cast<detail::ArgSlot<Index, T>&>(slots).value)) {
+                error.index = static_cast<int>(Index) + 1;
+                return false;
+            }
+            return true;
+        }
+
+        template<size_t... Indices>
+        static bool call(const CommandArgsView& args, ContextType* ctx, TypedArgsError& error,
+                         detail::index_sequence<Indices...>) {
+            Slots slots;
+            // Braced initializers are evaluated left to right, so the first failure wins
+            bool parsed[] = {true, parse_one<Indices, Params>(slots, args, error)...};
+            (void)parsed;
+            (void)slots;
+            if (error.index != 0) return false;
+
+            Handler(ctx, static_cast<detail::ArgSlot<Indices, Params>&>(slots).value...);
+            return true;
+        }
+    };
+
+/**
+ * Wrap a handler with typed parameters for use in a command table. The engine
+ * parses and validates every argument before the call and reports usage errors
+ * itself:
+ *
+ *   void set_led(MyAppContext* ctx, unsigned id, LedMode mode);
+ *   {"led", MCLI_TYPED(set_led), "Set LED <id> <off|on|blink>"}
+ */
+#define MCLI_TYPED(handler) (&::mcli::TypedCommand<decltype(&handler), &handler>::invoke)
+
+    // =============================================================================
+    // COMMAND TABLE VALIDATION
+    // =============================================================================
+
+    namespace detail {
+        // strcmp() usable in constant expressions (same ordering as strcmp)
+        constexpr int const_strcmp(const char* a, const char* b) {
+            return (*a != *b || !*a)
+                ? static_cast<int>(static_cast<unsigned char>(*a)) - static_cast<int>(static_cast<unsigned char>(*b))
+                : const_strcmp(a + 1, b + 1);
+        }
+
+        // Names the engine handles itself, which a table entry would shadow
+        constexpr bool is_builtin_name(const char* name) {
+#ifdef MCLI_ENABLE_STATS
+            return const_strcmp(name, "help") == 0 || const_strcmp(name, "stats") == 0;
+#else
+            return const_strcmp(name, "help") == 0;
+#endif
+        }
+
+        // Divide and conquer so recursion depth stays at log2(N) for large tables.
+        // Built-ins are only resolved at the top level, so only root entries can shadow them.
+        template<typename ContextType, typename ArgsType>
+        constexpr bool table_sorted(const CommandDefinition<ContextType, ArgsType>* commands, size_t lo, size_t hi, bool root) {
+            return (hi - lo < 2)
+                ? (hi == lo || ((!root || !is_builtin_name(commands[lo].name))
+                    && (commands[lo].kind != CommandKind::Group
+                        || table_sorted(commands[lo].children, 0, commands[lo].child_count, false))))
+                : table_sorted(commands, lo, lo + (hi - lo) / 2, root)
+                    && const_strcmp(commands[lo + (hi - lo) / 2 - 1].name, commands[lo + (hi - lo) / 2].name) < 0
+                    && table_sorted(commands, lo + (hi - lo) / 2, hi, root);
+        }
+    }
+
+    /**
+     * Check that a command table and all of its groups are strictly sorted by name
+     * (so they have no duplicates) and that the top-level table does not shadow the
+     * built-in commands (groups may have their own "help"). Sorted tables are dispatched with a
+     * binary search instead of a linear scan. Declare the table constexpr to check it
+     * at compile time:
+     *
+     *   constexpr mcli::CommandDefinition<MyAppContext> commands[] = { ... };
+     *   static_assert(mcli::command_table_sorted(commands), "commands must be sorted and unique");
+     */
+    template<typename ContextType, typename ArgsType, size_t N>
+    constexpr bool command_table_sorted(const CommandDefinition<ContextType, ArgsType> (&commands)[N]) {
+        return detail::table_sorted(commands, 0, N, true);
+    }
+
+    // =============================================================================
+    // STREAMING FORMATTER
+    // =============================================================================
+
+    namespace detail {
+        // Collects formatted output in a small chunk and streams it to the sink
+        template<typename Sink>
+        class FormatWriter {
+            public:
+                explicit FormatWriter(Sink& sink) : sink_(sink) {}
+
+                void put(char c) {
+                    if (used_ == sizeof(chunk_)) {
+                        drain();
+                    }
+                    chunk_[used_++] = c;
+                }
+
+                void write(const char* data, size_t len) {
+                    while (len > 0) {
+                        if (used_ == sizeof(chunk_)) {
+                            drain();
+                        }
+                        size_t room = sizeof(chunk_) - used_;
+                        size_t count = (len < room) ? len : room;
+                        memcpy(chunk_ + used_, data, count);
+                        used_ += count;
+                        data += count;
+                        len -= count;
+                    }
+                }
+
+                void pad(char c, int count) {
+                    while (count-- > 0) {
+                        put(c);
+                    }
+                }
+
+                void drain() {
+                    if (used_ > 0) {
+                        sink_.put_bytes(chunk_, used_);
+                        used_ = 0;
+                    }
+                }
+
+            private:
+                Sink& sink_;
+                char chunk_[32];
+                size_t used_ = 0;
+        };
+
+        struct FormatSpec {
+            bool left = false;
+            bool zero = false;
+            bool plus = false;
+            bool space = false;
+            bool alt = false;
+            int width = 0;
+            int precision = -1;
+        };
+
+        template<typename Sink, typename UnsignedType>
+        void format_integer(FormatWriter<Sink>& out, const FormatSpec& spec,
+                            UnsignedType value, bool negative, unsigned base, bool upper) {
+            const char* table = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+            char digits[24]; // 64-bit octal is 22 digits
+            int count = 0;
+            while (value) {
+                digits[count++] = table[value % base];
+                value /= base;
+            }
+
+            int zeros = ((spec.precision < 0) ? 1 : spec.precision) - count;
+            if (zeros < 0) zeros = 0;
+            if (spec.alt && base == 8 && zeros == 0) zeros = 1;
+
+            char prefix[2];
+            int prefix_len = 0;
+            if (negative) {
+                prefix[prefix_len++] = '-';
+            } else if (spec.plus) {
+                prefix[prefix_len++] = '+';
+            } else if (spec.space) {
+                prefix[prefix_len++] = ' ';
+            }
+            if (spec.alt && base == 16 && count > 0) {
+                prefix[0] = '0';
+                prefix[1] = upper ? 'X' : 'x';
+                prefix_len = 2;
+            }
+
+            int pad = spec.width - (prefix_len + zeros + count);
+            if (pad < 0) pad = 0;
+            if (spec.zero && !spec.left && spec.precision < 0) {
+                zeros += pad;
+                pad = 0;
+            }
+
+            if (!spec.left) out.pad(' ', pad);
+            out.write(prefix, prefix_len);
+            out.pad('0', zeros);
+            while (count > 0) {
+                out.put(digits[--count]);
+            }
+            if (spec.left) out.pad(' ', pad);
+        }
+
+        template<typename Sink>
+        void format_string(FormatWriter<Sink>& out, const FormatSpec& spec, const char* str, size_t len) {
+            int pad = spec.width - static_cast<int>(len);
+            if (!spec.left) out.pad(' ', pad);
+            out.write(str, len);
+            if (spec.left) out.pad(' ', pad);
+        }
+
+        /**
+         * printf-style formatter that streams straight into the sink in 32-byte
+         * chunks, so output length is unbounded and stack use is constant.
+         * Supports the flags -0+ #, width and precision (including *), the length
+         * modifiers hh h l ll z j t, and the conversions d i u o x X c s p %.
+         * Floating point conversions are handed to snprintf one value at a time
+         * (up to 63 characters each).
+         */
+        template<typename Sink>
+        void vformat(Sink& sink, const char* fmt, va_list args) {
+            FormatWriter<Sink> out(sink);
+
+            while (*fmt) {
+                // Copy literal runs in one go
+                const char* literal = fmt;
+                while (*fmt && *fmt != '%') fmt++;
+                out.write(literal, static_cast<size_t>(fmt - literal));
+                if (!*fmt) break;
+
+                const char* conversion_start = fmt++;
+                FormatSpec spec;
+
+                // Flags
+                for (;; fmt++) {
+                    if (*fmt == '-') spec.left = true;
+                    else if (*fmt == '0') spec.zero = true;
+                    else if (*fmt == '+') spec.plus = true;
+                    else if (*fmt == ' ') spec.space = true;
+                    else if (*fmt == '#') spec.alt = true;
+                    else break;
+                }
+
+                // Width
+                if (*fmt == '*') {
+                    spec.width = va_arg(args, int);
+                    if (spec.width < 0) {
+                        spec.left = true;
+                        spec.width = -spec.width;
+                    }
+                    fmt++;
+                } else {
+                    while (*fmt >= '0' && *fmt <= '9') {
+                        spec.width = spec.width * 10 + (*fmt++ - '0');
+                    }
+                }
+
+                // Precision
+                if (*fmt == '.') {
+                    fmt++;
+                    spec.precision = 0;
+                    if (*fmt == '*') {
+                        spec.precision = va_arg(args, int);
+                        if (spec.precision < 0) spec.precision = -1;
+                        fmt++;
+                    } else {
+                        while (*fmt >= '0' && *fmt <= '9') {
+                            spec.precision = spec.precision * 10 + (*fmt++ - '0');
+                        }
+                    }
+                }
+
+                // Length modifier
+                char length = 0;
+                if (*fmt == 'h' || *fmt == 'l') {
+                    length = *fmt++;
+                    if (*fmt == length) {
+                        length = static_cast<char>(length == 'h' ? 'H' : 'L');
+                        fmt++;
+                    }
+                } else if (*fmt == 'z' || *fmt == 'j' || *fmt == 't' || *fmt == 'L') {
+                    length = *fmt++;
+                }
+
+                char conversion = *fmt;
+                if (!conversion) break;
+                fmt++;
+
+                switch (conversion) {
+                    case 'd':
+                    case 'i': {
+                        long long value;
+                        if (length == 'L' || length == 'j') value = va_arg(args, long long);
+                        else if (length == 'l') value = va_arg(args, long);
+                        else if (length == 'z' || length == 't') value = va_arg(args, ptrdiff_t);
+                        else value = va_arg(args, int);
+                        if (length == 'H') value = static_cast<signed char>(value);
+                        else if (length == 'h') value = static_cast<short>(value);
+
+                        unsigned long long magnitude = (value < 0)
+                            ? 0ULL - static_cast<unsigned long long>(value)
+                            : static_cast<unsigned long long>(value);
+                        if (length == 'L' || length == 'j' || magnitude > static_cast<unsigned long>(-1)) {
+                            format_integer(out, spec, magnitude, value < 0, 10, false);
+                        } else {
+                            // Narrower arithmetic is much cheaper on 8/32-bit targets
+                            format_integer(out, spec, static_cast<unsigned long>(magnitude), value < 0, 10, false);
+                        }
+                        break;
+                    }
+                    case 'u':
+                    case 'o':
+                    case 'x':
+                    case 'X': {
+                        unsigned base = (conversion == 'u') ? 10 : (conversion == 'o') ? 8 : 16;
+                        bool upper = (conversion == 'X');
+                        spec.plus = spec.space = false;
+                        if (length == 'L' || length == 'j') {
+                            format_integer(out, spec, va_arg(args, unsigned long long), false, base, upper);
+                            break;
+                        }
+                        unsigned long value;
+                        if (length == 'l') value = va_arg(args, unsigned long);
+                        else if (length == 'z' || length == 't') value = va_arg(args, size_t);
+                        else value = va_arg(args, unsigned int);
+                        if (length == 'H') value = static_cast<unsigned char>(value);
+                        else if (length == 'h') value = static_cast<unsigned short>(value);
+                        format_integer(out, spec, value, false, base, upper);
+                        break;
+                    }
+                    case 'p': {
+                        spec.alt = true;
+                        spec.plus = spec.space = false;
+                        uintptr_t value = reinterpret_cast<uintptr_t>(va_arg(args, void*));
+                        format_integer(out, spec, static_cast<unsigned long long>(value), false, 16, false);
+                        break;
+                    }
+                    case 'c': {
+                        char c = static_cast<char>(va_arg(args, int));
+                        format_string(out, spec, &c, 1);
+                        break;
+                    }
+                    case 's': {
+                        const char* str = va_arg(args, const char*);
+                        if (!str) str = "(null)";
+                        size_t len = 0;
+                        while (str[len] && (spec.precision < 0 || len < static_cast<size_t>(spec.precision))) {
+                            len++;
+                        }
+                        format_string(out, spec, str, len);
+                        break;
+                    }
+                    case 'f': case 'F':
+                    case 'e': case 'E':
+                    case 'g': case 'G':
+                    case 'a': case 'A': {
+                        // Rebuild a single-value spec with '*' already resolved
+                        char single[24];
+                        char* cursor = single;
+                        *cursor++ = '%';
+                        if (spec.left) *cursor++ = '-';
+                        if (spec.zero) *cursor++ = '0';
+                        if (spec.plus) *cursor++ = '+';
+                        if (spec.space) *cursor++ = ' ';
+                        if (spec.alt) *cursor++ = '#';
+                        *cursor++ = '*';
+                        *cursor++ = '.';
+                        *cursor++ = '*';
+                        if (length == 'L') *cursor++ = 'L';
+                        *cursor++ = conversion;
+                        *cursor = '\0';
+
+                        char buffer[64];
+                        int len;
+                        if (length == 'L') {
+                            len = snprintf(buffer, sizeof(buffer), single, spec.width, spec.precision, va_arg(args, long double));
+                        } else {
+                            len = snprintf(buffer, sizeof(buffer), single, spec.width, spec.precision, va_arg(args, double));
+                        }
+                        if (len > 0) {
+                            out.write(buffer, (static_cast<size_t>(len) < sizeof(buffer)) ? static_cast<size_t>(len) : sizeof(buffer) - 1);
+                        }
+                        break;
+                    }
+                    case '%':
+                        out.put('%');
+                        break;
+                    default:
+                        // Unknown conversion, emit it verbatim
+                        out.write(conversion_start, static_cast<size_t>(fmt - conversion_start));
+                        break;
+                }
+            }
+
+            out.drain();
+        }
+    }
+
+    // =============================================================================
+    // FRAMED RPC
+    // =============================================================================
+
+    /**
+     * Wire format of the engine's framed mode. Every frame is COBS-encoded and
+     * ends with a 0x00 byte.
+     *
+     *   request:  [seq] [id lo] [id hi] { [len] [arg bytes] }...
+     *   data:     [seq] [FRAME_DATA] [output bytes]   (zero or more per request)
+     *   status:   [seq] [FRAME_STATUS] [FrameStatus]  (always last)
+     *
+     * Command IDs number the entries of the command tree in table order, depth
+     * first, starting at 1 (so group entries take an ID too). FRAME_ID_LOOKUP
+     * resolves a command path to its ID (sent back as two data bytes, little
+     * endian); FRAME_ID_EXIT returns to the text console.
+     */
+    constexpr uint8_t FRAME_STATUS = 0x00;
+    constexpr uint8_t FRAME_DATA = 0x01;
+    constexpr uint16_t FRAME_ID_LOOKUP = 0x0000;
+    constexpr uint16_t FRAME_ID_EXIT = 0xFFFF;
+
+    // Sent by the host on the text console to switch to framed mode
+    constexpr const char* FRAMED_MODE_SEQUENCE = "\x1b[77~";
+
+    enum class FrameStatus : uint8_t {
+        Ok = 0,
+        UnknownCommand = 1, // ID (or lookup path) names no runnable command
+        UsageError = 2,     // A typed command rejected its arguments
+        BadFrame = 3,       // Undecodable, truncated or oversized request
+    };
+
+    /**
+     * COBS-encode len bytes into out, which needs len + len / 254 + 1 bytes.
+     * The 0x00 delimiter is not added.
+     * @return Encoded length
+     */
+    inline size_t cobs_encode(const uint8_t* data, size_t len, uint8_t* out) {
+        size_t code_pos = 0;
+        size_t write = 1;
+        uint8_t code = 1;
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] == 0) {
+                out[code_pos] = code;
+                code_pos = write++;
+                code = 1;
+                continue;
+            }
+            out[write++] = data[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = write++;
+                code = 1;
+            }
+        }
+        out[code_pos] = code;
+        return write;
+    }
+
+    /**
+     * Decode a COBS frame (without its delimiter) in place.
+     * @return false if the frame is malformed
+     */
+    inline bool cobs_decode(uint8_t* data, size_t len, size_t& decoded_len) {
+        size_t read = 0;
+        size_t write = 0;
+        while (read < len) {
+            uint8_t code = data[read++];
+            if (code == 0 || read + code - 1 > len) {
+                return false;
+            }
+            for (uint8_t i = 1; i < code; i++) {
+                data[write++] = data[read++];
+            }
+            if (code != 0xFF && read < len) {
+                data[write++] = 0;
+            }
+        }
+        decoded_len = write;
+        return true;
+    }
+
+    // =============================================================================
+    // SCRIPTS
+    // =============================================================================
+
+    // Outcome of CliEngine::execute_script()
+    struct ScriptResult {
+        bool ok;             // Every line ran
+        uint32_t lines;      // Lines read, including blank and comment lines
+        uint32_t commands;   // Commands that ran successfully
+        uint32_t error_line; // 1-based line that stopped the script, 0 if ok
+        uint32_t elapsed_us; // From the engine clock, 0 without set_clock()
+    };
+
+    /**
+     * Sequential reader for scripts too large to map into memory, e.g. a file
+     * on SPIFFS/LittleFS (see FileScriptSource)
+     */
+    class ScriptSource {
+        public:
+            virtual ~ScriptSource() = default;
+
+            // Copy up to max_len bytes into buffer; 0 means the end of the script
+            virtual size_t read(char* buffer, size_t max_len) = 0;
+    };
+
+#ifdef MCLI_ENABLE_STATS
+    // =============================================================================
+    // COMMAND STATISTICS (build with -DMCLI_ENABLE_STATS)
+    // =============================================================================
+
+    // Counters for one command; times are in the engine clock's microseconds
+    struct CommandStats {
+        const void* command; // CommandDefinition this slot tracks, nullptr if free
+        uint32_t calls;
+        uint32_t last_us;
+        uint32_t max_us;
+        uint64_t total_us;
     };
 
+    // Link-level counters kept by the I/O adapter
+    struct IoStats {
+        uint32_t bytes_in;        // Payload bytes received
+        uint32_t bytes_out;       // Payload bytes accepted for sending
+        uint32_t put_calls;       // put_byte()/put_bytes() calls reaching the link
+        uint32_t partial_sends;   // Sends the link accepted only part of
+        uint32_t send_retries;    // Sends refused because the link was busy (EAGAIN)
+        uint32_t dropped_in;      // Received bytes consumed by the adapter (e.g. telnet commands)
+        uint32_t input_overflows; // Characters the engine dropped because the line or the typeahead held behind a running command was full
+    };
+
+    // Engine-wide counters
+    struct EngineStats {
+        uint32_t lines;          // Command lines tokenized
+        uint32_t parse_last_us;
+        uint32_t parse_max_us;
+        uint32_t unknown;        // Lines naming no command
+        uint32_t untracked;      // Calls not recorded because the stats table was full
+    };
+#endif
+
     // =============================================================================
     // CLI I/O INTERFACE
     // =============================================================================
@@ -98,34 +1036,102 @@ namespace mcli {
             print(str);
             println();
         }
-       virtual void printf(const char* fmt, ...) {
-            if (!fmt) return;
-    
+        virtual void printf(const char* fmt, ...) {
             va_list args;
             va_start(args, fmt);
-    
-            // Small stack-based buffer for embedded systems
-            char buffer[64];
-            int len = vsnprintf(buffer, sizeof(buffer), fmt, args);
+            vprintf(fmt, args);
             va_end(args);
-    
-            if (len > 0) {
-                // Ensure null termination and handle truncation
-                if (static_cast<uint32_t>(len) >= sizeof(buffer)) {
-                    len = sizeof(buffer) - 1;
-                    buffer[len] = '\0';
-                }
-                put_bytes(buffer, len);
-            }
         }
 
+        // Output is streamed to put_bytes() in small chunks and is never truncated
+        virtual void vprintf(const char* fmt, va_list args) {
+            if (!fmt) return;
+            detail::vformat(*this, fmt, args);
+        }
+
+        /**
+         * Push any staged output to the link. The engine calls this once per
+         * process_input() that produced output (after echo, command output and
+         * prompt), so buffering adapters can send everything in one batch.
+         */
         virtual void flush() {
             // Default implementation is no-op since byte-level interface
             // assumes immediate transmission. Override if buffering is used.
         }
-        
-        // Optional terminal control methods
-        // (Can be overridden for enhanced/alternate functionality)
+
+        /**
+         * Output space the link can take right now without blocking.
+         * @return Bytes, or WRITE_SPACE_UNLIMITED if the adapter cannot tell
+         */
+        virtual size_t writable_space() {
+            // Default implementation reports no backpressure, so writes may block
+            return WRITE_SPACE_UNLIMITED;
+        }
+
+        /**
+         * Non-blocking write: sends as much of data as fits right now. Streaming
+         * commands use this to throttle instead of stalling the main loop.
+         * @return Bytes accepted; the caller keeps the rest for a later try
+         */
+        virtual size_t try_put_bytes(const char* data, size_t len) {
+            size_t space = writable_space();
+            if (len > space) len = space;
+            if (len > 0) {
+                put_bytes(data, len);
+            }
+            return len;
+        }
+
+        /**
+         * Block until input is available or timeout_ms (WAIT_FOREVER for no
+         * limit) expires. Adapters override this with whatever their platform
+         * sleeps on (driver queue, select(), ...) so an idle console task uses no CPU.
+         * @return true if input may be ready, false on timeout
+         */
+        virtual bool readable_wait(uint32_t timeout_ms) {
+            // Default implementation cannot sleep, so it only reports current state
+            (void)timeout_ms;
+            return byte_available();
+        }
+
+        /**
+         * Low-power variant of readable_wait(), used by the engine once the
+         * console has sat idle at an empty prompt (see set_idle_timeout()).
+         * Adapters that can power down finish sending queued output, arm their
+         * wakeup source (UART wakeup, WiFi modem sleep, ...), wait, and restore
+         * normal operation before returning.
+         * @return true if input may be ready, false on timeout
+         */
+        virtual bool idle_wait(uint32_t timeout_ms) {
+            return readable_wait(timeout_ms);
+        }
+
+        /**
+         * Output framing for the engine's framed RPC mode (see FramedIo). While
+         * framing is on, output between framing_begin() and framing_end() goes out
+         * as data frames followed by a status frame.
+         * @return false if the adapter cannot frame
+         */
+        virtual bool set_framing(bool enabled) {
+            // Default implementation only writes plain text
+            return !enabled;
+        }
+        virtual void framing_begin(uint8_t seq) { (void)seq; }
+        virtual void framing_end(FrameStatus status) { (void)status; }
+        
+#ifdef MCLI_ENABLE_STATS
+        // Link counters; decorators forward to the adapter they wrap
+        virtual IoStats& io_stats() {
+            return io_stats_;
+        }
+
+        void reset_io_stats() {
+            io_stats() = IoStats();
+        }
+#endif
+
+        // Optional terminal control methods
+        // (Can be overridden for enhanced/alternate functionality)
         virtual void clear_screen() {
             print("\x1b[2J\r\n");
         }
@@ -134,255 +1140,2150 @@ namespace mcli {
             print(prompt);
         }
 
-        virtual void send_backspace() {
-            print("\b \b");
-        }
-    };
+        virtual void send_backspace() {
+            print("\b \b");
+        }
+
+    protected:
+        /**
+         * Counter hooks for adapters, called where bytes meet the link. They
+         * compile to nothing unless MCLI_ENABLE_STATS is defined.
+         */
+        void note_output(size_t len) {
+#ifdef MCLI_ENABLE_STATS
+            io_stats_.bytes_out += len;
+            io_stats_.put_calls++;
+#else
+            (void)len;
+#endif
+        }
+
+        void note_input(size_t len, size_t dropped = 0) {
+#ifdef MCLI_ENABLE_STATS
+            io_stats_.bytes_in += len;
+            io_stats_.dropped_in += dropped;
+#else
+            (void)len;
+            (void)dropped;
+#endif
+        }
+
+        void note_partial_send() {
+#ifdef MCLI_ENABLE_STATS
+            io_stats_.partial_sends++;
+#endif
+        }
+
+        void note_send_retry() {
+#ifdef MCLI_ENABLE_STATS
+            io_stats_.send_retries++;
+#endif
+        }
+
+#ifdef MCLI_ENABLE_STATS
+    private:
+        IoStats io_stats_ = IoStats();
+#endif
+    };
+
+    /**
+     * CRTP base for adapters: the helpers CliIoInterface builds on put_bytes()
+     * and friends (print(), printf(), prompts, ...) call the adapter's own
+     * methods by static type. Through a BasicCliEngine<Adapter, ...> and a
+     * final adapter that removes every virtual call on the I/O path; through
+     * CliIoInterface& it behaves exactly like the plain interface. Adapters
+     * meant to be subclassed leave out final; a final subclass of one gets
+     * the engine's calls bound directly.
+     *
+     *   class MyUartIo final : public mcli::CliIoAdapter<MyUartIo> { ... };
+     */
+    template<typename Derived>
+    class CliIoAdapter : public CliIoInterface {
+        public:
+            void put_bytes(const char* data, size_t len) override {
+                for (size_t count = 0; count < len; count++) {
+                    derived().put_byte(data[count]);
+                }
+            }
+
+            size_t get_bytes(char* buffer, size_t max_len) override {
+                size_t count = 0;
+                while (count < max_len && derived().byte_available()) {
+                    buffer[count++] = derived().get_byte();
+                }
+                return count;
+            }
+
+            void print(const char* str) override {
+                if (!str) return;
+
+                size_t len = strlen(str);
+                if (len > 0) {
+                    derived().put_bytes(str, len);
+                }
+            }
+            void println() override {
+                derived().print("\r\n");
+            }
+            void println(const char* str) override {
+                derived().print(str);
+                derived().println();
+            }
+            void printf(const char* fmt, ...) override {
+                va_list args;
+                va_start(args, fmt);
+                derived().vprintf(fmt, args);
+                va_end(args);
+            }
+
+            void vprintf(const char* fmt, va_list args) override {
+                if (!fmt) return;
+                detail::vformat(derived(), fmt, args);
+            }
+
+            bool readable_wait(uint32_t timeout_ms) override {
+                (void)timeout_ms;
+                return derived().byte_available();
+            }
+
+            bool idle_wait(uint32_t timeout_ms) override {
+                return derived().readable_wait(timeout_ms);
+            }
+
+            size_t try_put_bytes(const char* data, size_t len) override {
+                size_t space = derived().writable_space();
+                if (len > space) len = space;
+                if (len > 0) {
+                    derived().put_bytes(data, len);
+                }
+                return len;
+            }
+
+            void clear_screen() override {
+                derived().print("\x1b[2J\r\n");
+            }
+
+            void send_prompt(const char* prompt = DEFAULT_PROMPT) override {
+                derived().print(prompt);
+            }
+
+            void send_backspace() override {
+                derived().print("\b \b");
+            }
+
+        private:
+            Derived& derived() {
+                return static_cast<Derived&>(*this);
+            }
+    };
+
+    // =============================================================================
+    // ISR INPUT RING
+    // =============================================================================
+
+    namespace detail {
+        // Smallest free-running index that can hold 0..Capacity; one byte is
+        // naturally atomic on 8-bit targets
+        template<bool Small>
+        struct RingIndexSelect { using type = uint8_t; };
+
+        template<>
+        struct RingIndexSelect<false> { using type = size_t; };
+    }
+
+    /**
+     * Lock-free single-producer/single-consumer byte ring. The producer (an
+     * RX interrupt) calls push(), the consumer (the adapter's get_bytes() in
+     * the main loop) calls pop(); neither side blocks or disables interrupts.
+     *
+     *   static mcli::SpscRing<256> rx;
+     *   void uart_isr() { rx.push(UART_RX_REG); }
+     *   size_t got = rx.pop(buffer, max_len);   // One or two memcpy()s
+     *
+     * Capacity must be a power of two. Head and tail are free-running, so all
+     * Capacity bytes are usable. Up to 128 the indices are single bytes, which
+     * 8-bit MCUs read and write atomically; larger rings need a target with
+     * atomic size_t access (any 32-bit core).
+     */
+    template<size_t Capacity>
+    class SpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+#ifdef __AVR__
+        static_assert(Capacity <= 128, "AVR has no atomic multi-byte access; keep SpscRing at 128 bytes or less");
+#endif
+
+        using Index = typename detail::RingIndexSelect<(Capacity <= 128)>::type;
+
+        public:
+            static constexpr size_t capacity() { return Capacity; }
+
+            // Producer side: false (and counted in dropped()) if the ring is full
+            bool push(char c) {
+                Index head = head_;
+                if (static_cast<Index>(head - load_acquire(tail_)) == Capacity) {
+                    dropped_ = dropped_ + 1;
+                    return false;
+                }
+                data_[head & MASK] = c;
+                store_release(head_, static_cast<Index>(head + 1));
+                return true;
+            }
+
+            // Producer side: store as much of data as fits, count the rest as dropped
+            size_t push(const char* data, size_t len) {
+                Index head = head_;
+                size_t space = Capacity - static_cast<Index>(head - load_acquire(tail_));
+                if (len > space) {
+                    dropped_ = dropped_ + static_cast<uint32_t>(len - space);
+                    len = space;
+                }
+                copy_in(head & MASK, data, len);
+                store_release(head_, static_cast<Index>(head + len));
+                return len;
+            }
+
+            // Consumer side: move up to max_len bytes into out
+            size_t pop(char* out, size_t max_len) {
+                Index tail = tail_;
+                size_t count = static_cast<Index>(load_acquire(head_) - tail);
+                if (count > max_len) count = max_len;
+
+                size_t start = tail & MASK;
+                size_t first = Capacity - start;
+                if (first > count) first = count;
+                memcpy(out, data_ + start, first);
+                memcpy(out + first, data_, count - first);
+                store_release(tail_, static_cast<Index>(tail + count));
+                return count;
+            }
+
+            bool pop(char& c) {
+                return pop(&c, 1) == 1;
+            }
+
+            // Either side; a snapshot that may already be stale
+            size_t size() const {
+                return static_cast<Index>(load_acquire(head_) - load_acquire(tail_));
+            }
+
+            bool empty() const {
+                return size() == 0;
+            }
+
+            // Bytes the producer had to discard. Only a statistic: 8-bit targets
+            // may read it torn while the producer updates it.
+            uint32_t dropped() const {
+                return dropped_;
+            }
+
+            // Consumer side: discard everything received so far
+            void clear() {
+                store_release(tail_, load_acquire(head_));
+            }
+
+        private:
+            static constexpr size_t MASK = Capacity - 1;
+
+            template<typename T>
+            static T load_acquire(const T& value) {
+                return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+            }
+
+            template<typename T>
+            static void store_release(T& target, T value) {
+                __atomic_store_n(&target, value, __ATOMIC_RELEASE);
+            }
+
+            void copy_in(size_t start, const char* data, size_t len) {
+                size_t first = Capacity - start;
+                if (first > len) first = len;
+                memcpy(data_ + start, data, first);
+                memcpy(data_, data + first, len - first);
+            }
+
+            char data_[Capacity];
+            Index head_ = 0; // Written by the producer only
+            Index tail_ = 0; // Written by the consumer only
+            volatile uint32_t dropped_ = 0;
+    };
+
+    // =============================================================================
+    // LINE HISTORY
+    // =============================================================================
+
+    namespace detail {
+        /**
+         * Recent command lines packed into a byte ring. Each entry is stored as
+         * [len][chars][len], so it can be walked from the newest end and dropped
+         * from the oldest one; short lines cost two bytes of overhead, not a slot.
+         */
+        template<size_t Bytes>
+        class HistoryRing {
+            static_assert(Bytes >= 4, "History ring needs room for at least one short line");
+
+            public:
+                size_t count() const {
+                    return count_;
+                }
+
+                // Store a line, dropping the oldest ones to make room. Empty lines,
+                // repeats of the newest line and lines that cannot fit are skipped.
+                void push(const char* line, size_t len) {
+                    if (len == 0 || len > 0xFF || len + 2 > Bytes) {
+                        return;
+                    }
+                    if (count_ > 0 && newest_equals(line, len)) {
+                        return;
+                    }
+                    while (Bytes - used_ < len + 2) {
+                        drop_oldest();
+                    }
+
+                    data_[head_] = static_cast<uint8_t>(len);
+                    for (size_t i = 0; i < len; i++) {
+                        data_[(head_ + 1 + i) % Bytes] = static_cast<uint8_t>(line[i]);
+                    }
+                    data_[(head_ + 1 + len) % Bytes] = static_cast<uint8_t>(len);
+                    head_ = (head_ + len + 2) % Bytes;
+                    used_ += len + 2;
+                    count_++;
+                }
+
+                // Copy entry age (0 = newest) into out, return its length
+                size_t get(size_t age, char* out, size_t max_len) const {
+                    if (age >= count_) {
+                        return 0;
+                    }
+                    size_t end = head_;
+                    size_t len = 0;
+                    for (size_t i = 0; i <= age; i++) {
+                        len = data_[(end + Bytes - 1) % Bytes];
+                        end = (end + Bytes - len - 2) % Bytes;
+                    }
+
+                    size_t copied = (len < max_len) ? len : max_len;
+                    for (size_t i = 0; i < copied; i++) {
+                        out[i] = static_cast<char>(data_[(end + 1 + i) % Bytes]);
+                    }
+                    return copied;
+                }
+
+            private:
+                bool newest_equals(const char* line, size_t len) const {
+                    if (data_[(head_ + Bytes - 1) % Bytes] != len) {
+                        return false;
+                    }
+                    size_t start = (head_ + Bytes - len - 1) % Bytes;
+                    for (size_t i = 0; i < len; i++) {
+                        if (data_[(start + i) % Bytes] != static_cast<uint8_t>(line[i])) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                void drop_oldest() {
+                    size_t len = data_[tail_];
+                    tail_ = (tail_ + len + 2) % Bytes;
+                    used_ -= len + 2;
+                    count_--;
+                }
+
+                uint8_t data_[Bytes];
+                size_t head_ = 0; // Where the next entry goes
+                size_t tail_ = 0; // Oldest entry
+                size_t used_ = 0;
+                size_t count_ = 0;
+        };
+
+        // History disabled: no storage
+        template<>
+        class HistoryRing<0> {
+            public:
+                size_t count() const { return 0; }
+                void push(const char*, size_t) {}
+                size_t get(size_t, char*, size_t) const { return 0; }
+        };
+    }
+
+    // =============================================================================
+    // COMMAND DISPATCHER
+    // =============================================================================
+
+    /**
+     * Serializes command handlers of sessions that share state from different
+     * tasks (see BasicCliEngine::set_context_lock()). The task holding the lock
+     * must be able to take it again, because a handler may run commands itself.
+     */
+    class ContextLock {
+        public:
+            virtual ~ContextLock() {}
+            virtual void lock() = 0;
+            virtual void unlock() = 0;
+    };
+
+    namespace detail {
+        // Holds a ContextLock, if there is one, for the current scope
+        class ScopedContextLock {
+            public:
+                explicit ScopedContextLock(ContextLock* lock) : lock_(lock) {
+                    if (lock_) lock_->lock();
+                }
+                ~ScopedContextLock() {
+                    if (lock_) lock_->unlock();
+                }
+
+            private:
+                ContextLock* lock_;
+
+                ScopedContextLock(const ScopedContextLock&) = delete;
+                ScopedContextLock& operator=(const ScopedContextLock&) = delete;
+        };
+    }
+
+    /**
+     * The read-only half of an engine: a command tree and how to search it.
+     * It never changes after construction, so one dispatcher can back any
+     * number of sessions in any number of tasks. Sessions built from it skip
+     * the table checks and keep only their own line, history and task state.
+     *
+     *   const mcli::CommandDispatcher<AppContext> dispatcher(commands);
+     *   mcli::CliEngine<AppContext> uart_cli(uart_io, uart_ctx, dispatcher);
+     *   mcli::CliEngine<AppContext> wifi_cli(wifi_io, wifi_ctx, dispatcher);
+     */
+    template<typename ContextType, int MaxArgs = MAX_ARGS, int MaxArgLength = MAX_ARG_LENGTH>
+    class CommandDispatcher {
+        public:
+            using ArgsType = BasicCommandArgs<MaxArgs, MaxArgLength>;
+            using CommandType = CommandDefinition<ContextType, ArgsType>;
+
+            template<size_t N>
+            explicit CommandDispatcher(const CommandType (&commands)[N])
+                : commands_(commands), command_count_(N),
+                  // Sorted tables get O(log N) lookup; anything else falls back to a linear scan
+                  sorted_(tree_sorted(commands, N)) {}
+
+            const CommandType* commands() const {
+                return commands_;
+            }
+
+            size_t command_count() const {
+                return command_count_;
+            }
+
+            // True when every table in the tree is sorted, so lookups binary search
+            bool sorted() const {
+                return sorted_;
+            }
+
+            /**
+             * Walk the command tree along the arguments. On return args starts at the
+             * deepest command matched and depth is the number of groups descended. A
+             * group is returned when it has no further argument or the next one does
+             * not name one of its entries.
+             */
+            const CommandType* resolve_command(CommandArgsView& args, int& depth) const {
+                const CommandType* command = find_command(commands_, command_count_, args.argv[0]);
+                depth = 0;
+                while (command && command->kind == CommandKind::Group && args.argc > 1) {
+                    const CommandType* child = find_command(command->children, command->child_count, args.argv[1]);
+                    if (!child) {
+                        break;
+                    }
+                    command = child;
+                    args.argc--;
+                    args.argv++;
+                    args.lengths++;
+                    depth++;
+                }
+                return command;
+            }
+
+            // Look up a command by name in one table of the tree
+            const CommandType* find_command(const CommandType* table, size_t count, const char* name) const {
+                if (sorted_) {
+                    size_t lo = 0;
+                    size_t hi = count;
+                    while (lo < hi) {
+                        size_t mid = lo + (hi - lo) / 2;
+                        int cmp = strcmp(name, table[mid].name);
+                        if (cmp == 0) {
+                            return &table[mid];
+                        }
+                        if (cmp < 0) {
+                            hi = mid;
+                        } else {
+                            lo = mid + 1;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                for (size_t i = 0; i < count; i++) {
+                    if (strcmp(name, table[i].name) == 0) {
+                        return &table[i];
+                    }
+                }
+                return nullptr;
+            }
+
+            // Entry number remaining (1-based, depth first) of the tree, or nullptr
+            static const CommandType* command_by_id(const CommandType* table, size_t count, uint16_t& remaining) {
+                for (size_t i = 0; i < count && remaining > 0; i++) {
+                    if (--remaining == 0) {
+                        return &table[i];
+                    }
+                    if (table[i].kind == CommandKind::Group) {
+                        const CommandType* found = command_by_id(table[i].children, table[i].child_count, remaining);
+                        if (found) {
+                            return found;
+                        }
+                    }
+                }
+                return nullptr;
+            }
+
+            // Inverse of command_by_id(): id counts the entries visited up to target
+            static bool command_id(const CommandType* table, size_t count, const CommandType* target, uint16_t& id) {
+                for (size_t i = 0; i < count; i++) {
+                    id++;
+                    if (&table[i] == target) {
+                        return true;
+                    }
+                    if (table[i].kind == CommandKind::Group
+                        && command_id(table[i].children, table[i].child_count, target, id)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        private:
+            const CommandType* commands_;
+            size_t command_count_;
+            bool sorted_;
+
+            // True when every table in the tree is strictly sorted by name
+            static bool tree_sorted(const CommandType* table, size_t count) {
+                for (size_t i = 0; i < count; i++) {
+                    if (i > 0 && strcmp(table[i - 1].name, table[i].name) >= 0) {
+                        return false;
+                    }
+                    if (table[i].kind == CommandKind::Group && !tree_sorted(table[i].children, table[i].child_count)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+    };
+
+    // =============================================================================
+    // CLI ENGINE
+    // =============================================================================
+
+    /**
+     * Generic CLI engine that handles command parsing, dispatch, and I/O. 
+     * Template parameters allow for any application-specific context type, and
+     * size the line buffer and argument limits per instance:
+     *
+     *   mcli::CliEngine<DebugContext, 32, 3, 8> debug_cli(uart_io, debug_ctx, debug_commands);
+     *   mcli::CliEngine<ProvContext, 512> provisioning_cli(wifi_io, prov_ctx, prov_commands);
+     *
+     * HistoryBytes reserves a ring for up/down arrow recall (0 disables it):
+     *
+     *   mcli::CliEngine<AppContext, 128, 5, 12, 256> cli(uart_io, ctx, commands);
+     *
+     * Command tables must be declared as the engine's CommandType (the default
+     * limits match plain mcli::CommandDefinition<ContextType>).
+     *
+     * CliEngine talks to its adapter through the CliIoInterface vtable, so any
+     * adapter (or decorator chain) can be plugged in at run time. Where flash
+     * and cycles matter more, BasicCliEngine takes the adapter type itself;
+     * with a final adapter built on CliIoAdapter, echo, printing and input
+     * reads compile to direct, inlinable calls:
+     *
+     *   mcli::BasicCliEngine<ArduinoSerialIo, AppContext> cli(serial_io, ctx, commands);
+     */
+    template<typename IoType,
+             typename ContextType,
+             size_t BufferSize = CMD_BUFFER_SIZE,
+             int MaxArgs = MAX_ARGS,
+             int MaxArgLength = MAX_ARG_LENGTH,
+             size_t HistoryBytes = 0>
+    class BasicCliEngine {
+        static_assert(BufferSize >= 2, "CLI input buffer needs room for a character and terminator");
+
+        public:
+            using ArgsType = BasicCommandArgs<MaxArgs, MaxArgLength>;
+            using CommandType = CommandDefinition<ContextType, ArgsType>;
+            using DispatcherType = CommandDispatcher<ContextType, MaxArgs, MaxArgLength>;
+
+            /**
+             * Constructor
+             * @param io Reference to I/O interface implementation
+             * @param context Reference to application-specific context
+             * @param prompt Custom prompt string (optional)
+             */
+            template<size_t N>
+            BasicCliEngine(
+                IoType& io,
+                ContextType& context,
+                const CommandType (&commands)[N],
+                const char* prompt = DEFAULT_PROMPT )
+                : io_(io), context_(context), dispatcher_(commands),
+                prompt_(prompt) {}
+
+            /**
+             * Session on a dispatcher shared with other engines. Only the
+             * dispatcher's three words are copied; the table is not checked again.
+             * Sessions that reach the same state from different tasks need
+             * set_context_lock().
+             */
+            BasicCliEngine(
+                IoType& io,
+                ContextType& context,
+                const DispatcherType& dispatcher,
+                const char* prompt = DEFAULT_PROMPT )
+                : io_(io), context_(context), dispatcher_(dispatcher),
+                prompt_(prompt) {}
+
+
+            /**
+             * Main CLI loop -- runs indefinitely processing commands
+             */
+            void process_input() {
+                if (task_command_) {
+                    run_task_slice();
+                    return;
+                }
+
+                bool output_pending = false;
+                if (!prompt_sent_ && !framed_mode_) {
+                    show_prompt();
+                    output_pending = true;
+                }
+
+                // Try to read available data (non-blocking). Batch mode keeps reading
+                // so a pasted or scripted block is handled in one call.
+                char read_buffer[32];
+                size_t budget = batch_mode_ ? BATCH_READ_LIMIT : sizeof(read_buffer);
+                while (budget > 0) {
+                    size_t want = (budget < sizeof(read_buffer)) ? budget : sizeof(read_buffer);
+                    size_t buffer_len = read_input(read_buffer, want);
+                    if (buffer_len == 0) {
+                        break;
+                    }
+                    budget -= (buffer_len < budget) ? buffer_len : budget;
+                    output_pending = true;
+
+                    if (framed_mode_) {
+                        get_framed_input(read_buffer, buffer_len);
+                    } else if (batch_mode_) {
+                        get_batch_input(read_buffer, buffer_len);
+                    } else {
+                        get_command_input(read_buffer, buffer_len);
+                    }
+                    if (task_command_) {
+                        // A resumable command started, its first slice runs next call
+                        break;
+                    }
+                }
+
+                // Echo, command output and prompt go out as one batch
+                if (output_pending) {
+                    io_.flush();
+                }
+            }
+
+            /**
+             * Blocking variant of process_input() for RTOS tasks: sends the prompt,
+             * sleeps in the adapter's readable_wait() until input arrives, then
+             * processes it. With an idle timeout set, a wait at an empty prompt
+             * that runs past it continues in the adapter's idle_wait().
+             * @return true if input arrived before timeout_ms expired
+             */
+            bool process_input_blocking(uint32_t timeout_ms = WAIT_FOREVER) {
+                if (task_command_) {
+                    // Never sleep while a resumable command has work left, unless it
+                    // is waiting for the link to drain
+                    if (task_output_blocked()) {
+                        io_.readable_wait(1);
+                    }
+                    process_input();
+                    return true;
+                }
+                if (!prompt_sent_) {
+                    process_input();
+                }
+                if (!wait_for_input(timeout_ms)) {
+                    return false;
+                }
+                process_input();
+                return true;
+            }
+
+            /**
+             * Idle policy for process_input_blocking(): after idle_ms without input
+             * at an empty prompt, the wait moves to the adapter's idle_wait(), where
+             * it may light-sleep or power the radio down. A partly typed line never
+             * goes idle, because waking can cost characters (ESP32 UART wakeup
+             * consumes the bytes that trigger it). 0, the default, turns this off.
+             */
+            void set_idle_timeout(uint32_t idle_ms) {
+                idle_timeout_ms_ = idle_ms;
+            }
+
+            // Times process_input_blocking() has gone into idle_wait()
+            uint32_t idle_count() const {
+                return idle_count_;
+            }
+
+            /**
+             * Batch (machine) mode for scripted or pasted input: no echo, no line
+             * editing and no prompt, so host tools read bare command output. Whole
+             * lines are copied into the input buffer at once, and every complete line
+             * received is dispatched in the same process_input() call. Escape
+             * sequences are dropped, except FRAMED_MODE_SEQUENCE.
+             */
+            void set_batch_mode(bool enabled) {
+                batch_mode_ = enabled;
+                cursor_ = input_pos_;
+                escape_state_ = EscapeState::None;
+            }
+
+            bool batch_mode() const {
+                return batch_mode_;
+            }
+
+            /**
+             * Framed RPC mode for test automation: COBS frames carrying a command ID
+             * and length-prefixed arguments instead of text (see FRAME_DATA and
+             * friends for the format). Output is framed by the adapter, so the
+             * engine's adapter must support it (wrap it in FramedIo). Hosts can also
+             * switch over by sending FRAMED_MODE_SEQUENCE on the text console.
+             * Entering sends a status frame with seq 0 as an acknowledgement.
+             * @return false if the adapter cannot frame or a resumable command runs
+             */
+            bool set_framed_mode(bool enabled) {
+                if (enabled == framed_mode_) {
+                    return true;
+                }
+                if (enabled) {
+                    if (task_command_ || !io_.set_framing(true)) {
+                        return false;
+                    }
+                    framed_mode_ = true;
+                    frame_overflow_ = false;
+                    input_pos_ = 0;
+                    cursor_ = 0;
+                    escape_state_ = EscapeState::None;
+                    io_.framing_begin(0);
+                    io_.framing_end(FrameStatus::Ok);
+                } else {
+                    io_.set_framing(false);
+                    framed_mode_ = false;
+                    input_pos_ = 0;
+                    prompt_sent_ = false;
+                }
+                io_.flush();
+                return true;
+            }
+
+            bool framed_mode() const {
+                return framed_mode_;
+            }
+
+            /**
+             * Process a single command line (useful for testing or non-interactive use)
+             * @param command_line String containing the command and arguments
+             * @return true if the command ran; false if none matched, or it named
+             *         an unknown subcommand or failed its typed argument checks
+             */
+            bool execute_command(const char* command_line) {
+                // Tokenizing needs a writable copy of the caller's string
+                char line[BufferSize];
+                strncpy(line, command_line, BufferSize - 1);
+                line[BufferSize - 1] = '\0';
+
+                const char* argv[MaxArgs + 1];
+                size_t lengths[MaxArgs];
+                bool overflow = false;
+                CommandArgsView args = parse_command_line(line, argv, lengths, overflow);
+                return dispatch_command(args, false, overflow) == DispatchResult::Ran;
+            }
+
+            /**
+             * Run a script held in memory, e.g. a const string or a memory-mapped
+             * flash partition, one line at a time. Lines end in \n or \r\n; blank
+             * lines and lines starting with '#' are skipped. Nothing is echoed and
+             * no prompt is sent. The script stops at the first line naming an
+             * unknown command, failing typed argument checks or not fitting the
+             * line buffer. Resumable commands run to completion.
+             */
+            ScriptResult execute_script(const char* script, size_t len) {
+                ScriptResult result = {true, 0, 0, 0, 0};
+                uint32_t started = clock_ ? clock_() : 0;
+                while (len > 0 && result.ok) {
+                    const char* end = static_cast<const char*>(memchr(script, '\n', len));
+                    size_t span = end ? static_cast<size_t>(end - script) : len;
+                    run_script_line(script, span, result);
+                    size_t consumed = end ? span + 1 : span;
+                    script += consumed;
+                    len -= consumed;
+                }
+                finish_script(result, started);
+                return result;
+            }
+
+            /**
+             * Run a script streamed from a ScriptSource, with the same rules as
+             * above. Reads go through a chunk on the stack sized for the longest
+             * line the engine's line buffer takes with its \r\n, so both overloads
+             * accept the same lines.
+             */
+            ScriptResult execute_script(ScriptSource& source) {
+                ScriptResult result = {true, 0, 0, 0, 0};
+                uint32_t started = clock_ ? clock_() : 0;
+                char chunk[BufferSize + 1];
+                size_t held = 0;
+                bool at_end = false;
+                while (result.ok) {
+                    const char* end = static_cast<const char*>(memchr(chunk, '\n', held));
+                    if (!end && !at_end && held < sizeof(chunk)) {
+                        size_t got = source.read(chunk + held, sizeof(chunk) - held);
+                        at_end = (got == 0);
+                        held += got;
+                        continue;
+                    }
+                    if (!end && held == 0) {
+                        break;
+                    }
+
+                    // A full chunk without a newline is a line too long to run
+                    size_t span = end ? static_cast<size_t>(end - chunk) : held;
+                    run_script_line(chunk, span, result);
+                    size_t consumed = end ? span + 1 : span;
+                    memmove(chunk, chunk + consumed, held - consumed);
+                    held -= consumed;
+                }
+                finish_script(result, started);
+                return result;
+            }
+
+            /**
+             * Clock used to time-box resumable commands (and to time commands
+             * for stats), in microseconds, e.g. micros() or esp_timer_get_time().
+             * Without a clock each process_input() runs a single step.
+             */
+            void set_clock(uint32_t (*now_us)()) {
+                clock_ = now_us;
+            }
+
+            // Keep calling a resumable command's step for up to slice_us per process_input()
+            void set_task_slice(uint32_t slice_us) {
+                task_slice_us_ = slice_us;
+            }
+
+            /**
+             * Output backpressure for resumable commands: a step only runs while
+             * the link can take at least bytes without blocking (see
+             * CliIoInterface::writable_space()). Size it to the most a step
+             * prints. 0, the default, never holds a step back.
+             */
+            void set_task_output_reserve(size_t bytes) {
+                task_output_reserve_ = bytes;
+            }
+
+            /**
+             * Run command handlers under lock. Give every session that reaches the
+             * same state from another task the same lock (see FreeRtosContextLock).
+             * Commands flagged CMD_REENTRANT skip it and run in parallel. A resumable
+             * command holds it for one step at a time, so other sessions get in
+             * between steps. nullptr, the default, runs handlers unlocked.
+             */
+            void set_context_lock(ContextLock* lock) {
+                context_lock_ = lock;
+            }
+
+            const DispatcherType& dispatcher() const {
+                return dispatcher_;
+            }
+
+            // True while a resumable command is in progress
+            bool task_running() const {
+                return task_command_ != nullptr;
+            }
+
+            // Stop the running resumable command, as if Ctrl-C was received
+            void cancel_task() {
+                if (task_command_) {
+                    stop_task();
+                    io_.println("^C");
+                    finish_task();
+                    io_.flush();
+                }
+            }
+
+#ifdef MCLI_ENABLE_STATS
+            /**
+             * Storage for per-command counters, one slot per command to track.
+             * Times come from set_clock(); without one only counts are kept.
+             *   static mcli::CommandStats cli_stats[16];
+             *   cli.set_stats_storage(cli_stats);
+             */
+            template<size_t N>
+            void set_stats_storage(CommandStats (&slots)[N]) {
+                stats_ = slots;
+                stats_capacity_ = N;
+                reset_stats();
+            }
+
+            // Clears command, engine and I/O counters
+            void reset_stats() {
+                if (stats_) {
+                    memset(stats_, 0, sizeof(CommandStats) * stats_capacity_);
+                }
+                engine_stats_ = EngineStats();
+                io_.reset_io_stats();
+            }
+
+            // Counters for a command, or nullptr if it has not run (or is not tracked)
+            const CommandStats* command_stats(const CommandType& command) const {
+                const CommandStats* slot = find_stats(&command);
+                return (slot && slot->command) ? slot : nullptr;
+            }
+
+            const EngineStats& engine_stats() const {
+                return engine_stats_;
+            }
+
+            /**
+             * Print the counters (the built-in "stats" command)
+             */
+            void print_stats() {
+                io_.println();
+                io_.printf("Lines: %lu (%lu unknown), parse last/max: %lu/%lu us\r\n",
+                           (unsigned long)engine_stats_.lines, (unsigned long)engine_stats_.unknown,
+                           (unsigned long)engine_stats_.parse_last_us, (unsigned long)engine_stats_.parse_max_us);
+                const IoStats& io = io_.io_stats();
+                io_.printf("I/O: %lu bytes in (%lu dropped, %lu overflowed), %lu bytes out in %lu writes\r\n",
+                           (unsigned long)io.bytes_in, (unsigned long)io.dropped_in, (unsigned long)io.input_overflows,
+                           (unsigned long)io.bytes_out, (unsigned long)io.put_calls);
+                io_.printf("     %lu partial sends, %lu busy retries\r\n",
+                           (unsigned long)io.partial_sends, (unsigned long)io.send_retries);
+                if (!stats_) {
+                    io_.println("  (No stats storage set)");
+                    io_.println();
+                    return;
+                }
+
+                size_t max_name_len = strlen("command");
+                for (size_t i = 0; i < stats_capacity_; i++) {
+                    if (stats_[i].command) {
+                        size_t len = strlen(static_cast<const CommandType*>(stats_[i].command)->name);
+                        if (len > max_name_len) {
+                            max_name_len = len;
+                        }
+                    }
+                }
+                const int width = static_cast<int>(max_name_len);
+
+                io_.printf("  %-*s %8s %8s %8s %8s\r\n", width, "command", "calls", "last_us", "max_us", "avg_us");
+                for (size_t i = 0; i < stats_capacity_; i++) {
+                    const CommandStats& slot = stats_[i];
+                    if (!slot.command) continue;
+                    io_.printf("  %-*s %8lu %8lu %8lu %8lu\r\n", width,
+                               static_cast<const CommandType*>(slot.command)->name,
+                               (unsigned long)slot.calls, (unsigned long)slot.last_us, (unsigned long)slot.max_us,
+                               (unsigned long)(slot.calls ? slot.total_us / slot.calls : 0));
+                }
+                if (engine_stats_.untracked > 0) {
+                    io_.printf("  (%lu calls not tracked, stats table full)\r\n", (unsigned long)engine_stats_.untracked);
+                }
+                io_.println();
+            }
+#endif
+
+            /**
+             * Print available commands
+             */
+            void print_help() {
+                io_.println();
+                io_.println("Available commands:");
+                print_command_list(dispatcher_.commands(), dispatcher_.command_count(), true);
+                io_.println();
+            }
+
+            // Reset CLI state between connections
+            void reset_session() {
+                // Let a resumable command clean up, nobody is there to see it finish
+                if (task_command_) {
+                    stop_task();
+                    task_command_ = nullptr;
+                }
+
+                // New sessions start on the text console
+                if (framed_mode_) {
+                    io_.set_framing(false);
+                    framed_mode_ = false;
+                }
+
+                // Clear input buffer
+                memset(input_buffer_, 0, sizeof(input_buffer_));
+                input_pos_ = 0;
+                typeahead_len_ = 0;
+                cursor_ = 0;
+                history_pos_ = 0;
+                escape_state_ = EscapeState::None;
+                last_line_char_ = 0;
+                prompt_sent_ = false;
+            }
+            
+        private:
+            // Tokenize a line in place into argc/argv format; overflow is set if tokens were dropped
+            CommandArgsView parse_command_line(char* line, const char** argv, size_t* lengths, bool& overflow) {
+#ifdef MCLI_ENABLE_STATS
+                uint32_t started = now_us();
+#endif
+                CommandArgsView args;
+                args.argc = tokenize_in_place(line, argv, lengths, MaxArgs, &overflow);
+                args.argv = argv;
+                args.lengths = lengths;
+#ifdef MCLI_ENABLE_STATS
+                uint32_t elapsed = now_us() - started;
+                engine_stats_.lines++;
+                engine_stats_.parse_last_us = elapsed;
+                if (elapsed > engine_stats_.parse_max_us) {
+                    engine_stats_.parse_max_us = elapsed;
+                }
+#endif
+                return args;
+            }
+
+            // Copy a view into the fixed-size legacy argument structure
+            static ArgsType copy_command_args(const CommandArgsView& view) {
+                ArgsType args;
+                while (args.argc < view.argc && args.argc < MaxArgs - 1) {
+                    strncpy(args.argv[args.argc], view.argv[args.argc], MaxArgLength - 1);
+                    args.argc++;
+                }
+                return args;
+            }
+
+            // Consume received bytes with echo, line editing and history recall
+            void get_command_input(const char* read_buffer, size_t buffer_len) {
+                // Process each character from the buffer
+                for (size_t i = 0; i < buffer_len; i++) {
+                    uint8_t in_char = 0;
+
+                    // Get the next character from the buffer
+                    in_char = read_buffer[i];
+
+                    // Cursor keys and other VT100 sequences
+                    if (escape_state_ != EscapeState::None || in_char == 0x1b) {
+                        handle_escape(in_char);
+                        last_line_char_ = 0;
+                        if (framed_mode_) {
+                            // The host switched to framed mode, the rest is frames
+                            get_framed_input(read_buffer + i + 1, buffer_len - i - 1);
+                            return;
+                        }
+                        continue;
+                    }
+                
+                    // Handle backspace
+                    if (in_char == 8 || in_char == 127) {
+                        erase_before_cursor();
+                        last_line_char_ = 0;
+                        continue;
+                    }
+
+                    // Handle TAB completion
+                    if (in_char == '\t') {
+                        complete_at_cursor();
+                        last_line_char_ = 0;
+                        continue;
+                    }
+                
+                    // Handle CRLF
+                    if (in_char == '\r' || in_char == '\n') {
+                        // If this is \n and we just processed \r, skip it
+                        if ((in_char == '\n') && (last_line_char_ == '\r')) {
+                            last_line_char_ = in_char;
+                            continue;
+                        }
+                        last_line_char_ = in_char;
+
+                        io_.println();
+                        run_input_line();
+                        if (task_command_) {
+                            hold_input(read_buffer + i + 1, buffer_len - i - 1);
+                            return;
+                        }
+                        continue;
+                    }
+                
+                    // Handle regular characters
+                    last_line_char_ = 0;
+                    insert_at_cursor(in_char);
+                }
+            }
+
+            // =========================================================================
+            // Line editing. Redraws send as few bytes as possible: cursor moves of up
+            // to three columns use backspaces or reprint the characters, longer ones
+            // use a CSI sequence.
+            // =========================================================================
+
+            enum class EscapeState : uint8_t { None, Esc, Csi };
+
+            // Collect an escape sequence one byte at a time; unknown ones are dropped
+            void handle_escape(uint8_t c) {
+                switch (escape_state_) {
+                    case EscapeState::None:
+                        escape_state_ = EscapeState::Esc;
+                        escape_param_ = 0;
+                        return;
+                    case EscapeState::Esc:
+                        // CSI ("ESC [") and SS3 ("ESC O") carry the cursor keys
+                        escape_state_ = (c == '[' || c == 'O') ? EscapeState::Csi : EscapeState::None;
+                        return;
+                    case EscapeState::Csi:
+                        if (c >= '0' && c <= '9') {
+                            if (escape_param_ < 100) {
+                                escape_param_ = static_cast<uint8_t>(escape_param_ * 10 + (c - '0'));
+                            }
+                            return;
+                        }
+                        if (c >= 0x40 && c <= 0x7e) {
+                            escape_state_ = EscapeState::None;
+                            run_escape(c);
+                        }
+                        return;
+                }
+            }
+
+            void run_escape(uint8_t final_byte) {
+                if (batch_mode_ && !(final_byte == '~' && escape_param_ == 77)) {
+                    // No line editing in batch mode
+                    return;
+                }
+                switch (final_byte) {
+                    case 'A': recall_history(true); break;
+                    case 'B': recall_history(false); break;
+                    case 'C': move_cursor_to(cursor_ < input_pos_ ? cursor_ + 1 : cursor_); break;
+                    case 'D': move_cursor_to(cursor_ > 0 ? cursor_ - 1 : 0); break;
+                    case 'H': move_cursor_to(0); break;
+                    case 'F': move_cursor_to(input_pos_); break;
+                    case '~':
+                        // VT220 keys: 1/7 Home, 4/8 End, 3 Delete
+                        if (escape_param_ == 1 || escape_param_ == 7) {
+                            move_cursor_to(0);
+                        } else if (escape_param_ == 4 || escape_param_ == 8) {
+                            move_cursor_to(input_pos_);
+                        } else if (escape_param_ == 3) {
+                            erase_at_cursor();
+                        } else if (escape_param_ == 77) {
+                            // FRAMED_MODE_SEQUENCE
+                            if (!set_framed_mode(true)) {
+                                if (!batch_mode_) io_.println();
+                                io_.println("Framed mode needs a framing adapter (FramedIo).");
+                                if (!batch_mode_) {
+                                    io_.send_prompt(prompt_);
+                                    io_.put_bytes(input_buffer_, input_pos_);
+                                }
+                                cursor_ = input_pos_;
+                            }
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            void insert_at_cursor(char c) {
+                if (input_pos_ >= BufferSize - 1) {
+#ifdef MCLI_ENABLE_STATS
+                    io_.io_stats().input_overflows++;
+#endif
+                    return;
+                }
+                if (cursor_ == input_pos_) {
+                    io_.put_byte(c);
+                    input_buffer_[input_pos_++] = c;
+                    cursor_++;
+                    return;
+                }
+
+                // Mid-line: shift the tail right and reprint it
+                memmove(input_buffer_ + cursor_ + 1, input_buffer_ + cursor_, input_pos_ - cursor_);
+                input_buffer_[cursor_] = c;
+                input_pos_++;
+                io_.put_bytes(input_buffer_ + cursor_, input_pos_ - cursor_);
+                cursor_++;
+                send_cursor_left(input_pos_ - cursor_);
+            }
+
+            void erase_before_cursor() {
+                if (cursor_ == 0) {
+                    return;
+                }
+                if (cursor_ == input_pos_) {
+                    input_pos_--;
+                    cursor_--;
+                    input_buffer_[input_pos_] = '\0';
+                    io_.send_backspace();
+                    return;
+                }
+
+                memmove(input_buffer_ + cursor_ - 1, input_buffer_ + cursor_, input_pos_ - cursor_);
+                cursor_--;
+                input_pos_--;
+                io_.put_byte('\b');
+                redraw_tail(1);
+            }
+
+            void erase_at_cursor() {
+                if (cursor_ == input_pos_) {
+                    return;
+                }
+                memmove(input_buffer_ + cursor_, input_buffer_ + cursor_ + 1, input_pos_ - cursor_ - 1);
+                input_pos_--;
+                redraw_tail(1);
+            }
+
+            // Reprint from the cursor to the end, blank the erased columns, come back
+            void redraw_tail(size_t erased) {
+                io_.put_bytes(input_buffer_ + cursor_, input_pos_ - cursor_);
+                for (size_t i = 0; i < erased; i++) {
+                    io_.put_byte(' ');
+                }
+                send_cursor_left(input_pos_ - cursor_ + erased);
+            }
+
+            void move_cursor_to(size_t column) {
+                if (column < cursor_) {
+                    send_cursor_left(cursor_ - column);
+                } else if (column > cursor_) {
+                    if (column - cursor_ <= 3) {
+                        // Reprinting the characters is shorter than "ESC [ n C"
+                        io_.put_bytes(input_buffer_ + cursor_, column - cursor_);
+                    } else {
+                        io_.printf("\x1b[%uC", static_cast<unsigned>(column - cursor_));
+                    }
+                }
+                cursor_ = column;
+            }
+
+            void send_cursor_left(size_t columns) {
+                if (columns > 3) {
+                    io_.printf("\x1b[%uD", static_cast<unsigned>(columns));
+                    return;
+                }
+                for (size_t i = 0; i < columns; i++) {
+                    io_.put_byte('\b');
+                }
+            }
+
+            /**
+             * TAB: complete the last word from the command tree. Earlier words pick
+             * the group (a leading "help" is skipped); a unique match is finished with
+             * a space, several matches are extended to their common prefix, or listed
+             * if that adds nothing. Only the added characters are echoed.
+             */
+            void complete_at_cursor() {
+                if (cursor_ != input_pos_) {
+                    io_.put_byte('\a');
+                    return;
+                }
+
+                const CommandType* table = dispatcher_.commands();
+                size_t count = dispatcher_.command_count();
+                bool first_word = true;
+                bool builtins = true;
+                size_t pos = 0;
+                while (true) {
+                    while (pos < input_pos_ && input_buffer_[pos] == ' ') pos++;
+                    size_t start = pos;
+                    while (pos < input_pos_ && input_buffer_[pos] != ' ') pos++;
+                    const char* word = input_buffer_ + start;
+                    size_t len = pos - start;
+
+                    if (pos == input_pos_) {
+                        complete_word(table, count, builtins, word, len);
+                        return;
+                    }
+
+                    // Look the finished word up in place, NUL-terminating it for a moment
+                    input_buffer_[pos] = '\0';
+                    bool is_help = first_word && strcmp(word, "help") == 0;
+                    const CommandType* command = is_help ? nullptr : dispatcher_.find_command(table, count, word);
+                    input_buffer_[pos] = ' ';
+
+                    if (!is_help) {
+                        if (!command || command->kind != CommandKind::Group) {
+                            // Arguments of a command are not completed
+                            io_.put_byte('\a');
+                            return;
+                        }
+                        table = command->children;
+                        count = command->child_count;
+                    }
+                    first_word = false;
+                    builtins = false;
+                }
+            }
+
+            void complete_word(const CommandType* table, size_t count, bool builtins,
+                               const char* word, size_t len) {
+                const char* first = nullptr;
+                size_t common = 0;
+                size_t matches = 0;
+                for_each_completion(table, count, builtins, word, len, [&](const char* name) {
+                    if (!first) {
+                        first = name;
+                        common = strlen(name);
+                    } else {
+                        size_t same = len;
+                        while (same < common && name[same] == first[same]) same++;
+                        common = same;
+                    }
+                    matches++;
+                });
+
+                if (matches == 0) {
+                    io_.put_byte('\a');
+                    return;
+                }
+                if (common > len || matches == 1) {
+                    for (size_t i = len; i < common; i++) {
+                        insert_at_cursor(first[i]);
+                    }
+                    if (matches == 1) {
+                        insert_at_cursor(' ');
+                    }
+                    return;
+                }
+
+                // Nothing to add: show the candidates and redraw the line below them
+                io_.println();
+                for_each_completion(table, count, builtins, word, len, [&](const char* name) {
+                    io_.print(name);
+                    io_.print("  ");
+                });
+                io_.println();
+                io_.send_prompt(prompt_);
+                io_.put_bytes(input_buffer_, input_pos_);
+            }
+
+            // Call fn for every name in table (and the built-ins) starting with word
+            template<typename Fn>
+            void for_each_completion(const CommandType* table, size_t count, bool builtins,
+                                     const char* word, size_t len, Fn fn) const {
+                if (builtins) {
+                    if (strncmp("help", word, len) == 0) fn("help");
+#ifdef MCLI_ENABLE_STATS
+                    if (strncmp("stats", word, len) == 0) fn("stats");
+#endif
+                }
+
+                size_t i = 0;
+                if (dispatcher_.sorted()) {
+                    // Matches form one run in a sorted table, starting at the first name >= word
+                    size_t hi = count;
+                    while (i < hi) {
+                        size_t mid = i + (hi - i) / 2;
+                        if (strncmp(table[mid].name, word, len) < 0) {
+                            i = mid + 1;
+                        } else {
+                            hi = mid;
+                        }
+                    }
+                }
+                for (; i < count; i++) {
+                    if (strncmp(table[i].name, word, len) == 0) {
+                        fn(table[i].name);
+                    } else if (dispatcher_.sorted()) {
+                        break;
+                    }
+                }
+            }
+
+            // Up/down: swap in an older or newer line; past the newest is an empty line
+            void recall_history(bool older) {
+                if (older) {
+                    if (history_pos_ >= history_.count()) return;
+                    history_pos_++;
+                } else {
+                    if (history_pos_ == 0) return;
+                    history_pos_--;
+                }
+
+                char line[BufferSize];
+                size_t len = (history_pos_ > 0) ? history_.get(history_pos_ - 1, line, BufferSize - 1) : 0;
+                replace_line(line, len);
+            }
+
+            // Redraw only from the first column that differs from the current line
+            void replace_line(const char* line, size_t len) {
+                size_t common = 0;
+                while (common < len && common < input_pos_ && line[common] == input_buffer_[common]) {
+                    common++;
+                }
+                move_cursor_to(common);
+
+                memcpy(input_buffer_ + common, line + common, len - common);
+                io_.put_bytes(input_buffer_ + common, len - common);
+                if (input_pos_ > len) {
+                    io_.print("\x1b[K");
+                }
+                input_pos_ = len;
+                cursor_ = len;
+            }
+
+            // Consume received bytes in batch mode, copying whole line spans at a time
+            void get_batch_input(const char* data, size_t len) {
+                while (len > 0) {
+                    if (escape_state_ != EscapeState::None || data[0] == 0x1b) {
+                        handle_escape(static_cast<uint8_t>(data[0]));
+                        data++;
+                        len--;
+                        last_line_char_ = 0;
+                        if (framed_mode_) {
+                            // The host switched to framed mode, the rest is frames
+                            get_framed_input(data, len);
+                            return;
+                        }
+                        continue;
+                    }
 
-    // =============================================================================
-    // CLI ENGINE
-    // =============================================================================
+                    size_t line_end = find_line_end(data, len);
+                    const char* escape = static_cast<const char*>(memchr(data, 0x1b, line_end));
+                    size_t span = escape ? static_cast<size_t>(escape - data) : line_end;
+                    if (span > 0) {
+                        size_t room = BufferSize - 1 - input_pos_;
+                        memcpy(input_buffer_ + input_pos_, data, (span < room) ? span : room);
+                        input_pos_ += (span < room) ? span : room;
+#ifdef MCLI_ENABLE_STATS
+                        if (span > room) {
+                            io_.io_stats().input_overflows += span - room;
+                        }
+#endif
+                        last_line_char_ = 0;
+                    }
+                    if (escape) {
+                        // The sequence is handled on the next pass
+                        data += span;
+                        len -= span;
+                        continue;
+                    }
+                    if (span == len) {
+                        // Partial line, wait for the rest
+                        return;
+                    }
 
-    /**
-     * Generic CLI engine that handles command parsing, dispatch, and I/O. 
-     * Template parameter allows for any application-specific context type.
-     */
-    template<typename ContextType>
-    class CliEngine {
-        public:
-            /**
-             * Constructor
-             * @param io Reference to I/O interface implementation
-             * @param context Reference to application-specific context
-             * @param prompt Custom prompt string (optional)
-             */
-            template<size_t N>
-            CliEngine(
-                CliIoInterface& io,
-                ContextType& context,
-                const CommandDefinition<ContextType> (&commands)[N],
-                const char* prompt = DEFAULT_PROMPT )
-                : io_(io), context_(context), 
-                commands_(commands), command_count_(N),
-                prompt_(prompt) {}
+                    char terminator = data[span];
+                    data += span + 1;
+                    len -= span + 1;
 
+                    // If this is \n right after \r, skip it
+                    if (span == 0 && terminator == '\n' && last_line_char_ == '\r') {
+                        last_line_char_ = terminator;
+                        continue;
+                    }
+                    last_line_char_ = terminator;
 
-            /**
-             * Main CLI loop -- runs indefinitely processing commands
-             */
-            void process_input() {
-                if (!prompt_sent_) {
-                    io_.send_prompt(prompt_);
-                    prompt_sent_ = true;
+                    run_input_line();
+                    if (task_command_) {
+                        hold_input(data, len);
+                        return;
+                    }
                 }
+            }
+
+            // Tokenize and run the line in input_buffer_, then prompt for the next one
+            void run_input_line() {
+                cursor_ = 0;
+                history_pos_ = 0;
+                if (input_pos_ > 0) {
+                    // Saved before tokenizing splits the line up
+                    history_.push(input_buffer_, input_pos_);
+                    input_buffer_[input_pos_] = '\0';
 
-                CommandArgs args = get_command_input();
-                if (args.argc > 0) {
-                    if (!dispatch_command(args)) {
+                    const char* argv[MaxArgs + 1];
+                    size_t lengths[MaxArgs];
+                    bool overflow = false;
+                    CommandArgsView args = parse_command_line(input_buffer_, argv, lengths, overflow);
+                    if (args.argc > 0 && dispatch_command(args, true, overflow) == DispatchResult::NotFound) {
                             io_.print("Command \"");
                             io_.print(args.argv[0]);
                             io_.println("\" not found. Type 'help' for available commands.");
                     }
-                    prompt_sent_ = false;
+                    if (task_command_) {
+                        // The line stays in input_buffer_ until the command finishes
+                        return;
+                    }
+
+                    // Reset input buffer
+                    input_buffer_[0] = '\0';
+                    input_pos_ = 0;
                 }
+
+                show_prompt();
             }
 
-            /**
-             * Process a single command line (useful for testing or non-interactive use)
-             * @param command_line String containing the command and arguments
-             * @return true if command was found and executed, false otherwise
-             */
-            bool execute_command(const char* command_line) {
-                CommandArgs args = parse_command_line(command_line);
-                return dispatch_command(args);
+            // Batch mode leaves the prompt out so host tools get bare command output
+            void show_prompt() {
+                if (!batch_mode_) {
+                    io_.send_prompt(prompt_);
+                }
+                prompt_sent_ = true;
             }
 
+            enum class DispatchResult : uint8_t {
+                Ran,
+                NotFound, // No command by that name; the caller reports it
+                Failed,   // Unknown subcommand or bad typed arguments, already reported
+            };
+
             /**
-             * Print available commands
+             * Find and execute a command. Resumable commands from the input stream
+             * (deferrable) run in slices from process_input(); anywhere else they
+             * run to completion here. overflow says the line had more than MaxArgs
+             * tokens, which typed commands reject.
              */
-            void print_help() {
-                // Figure out the longest command name for padding
-                size_t max_name_len = strlen("help");
-                for (size_t i = 0; i < command_count_; i++) {
-                    size_t len = strlen(commands_[i].name);
-                    if (len > max_name_len) {
-                        max_name_len = len;
+            DispatchResult dispatch_command(const CommandArgsView& args, bool deferrable, bool overflow) {
+                if (args.argc == 0) {
+                    return DispatchResult::NotFound;
+                }
+            
+                // Handle built-in commands first
+                if (strcmp(args.argv[0], "help") == 0) {
+                    run_help(args);
+                    return DispatchResult::Ran;
+                }
+#ifdef MCLI_ENABLE_STATS
+                if (strcmp(args.argv[0], "stats") == 0) {
+                    if (args.argc > 1 && strcmp(args.argv[1], "reset") == 0) {
+                        reset_stats();
+                        io_.println("Stats cleared.");
+                    } else {
+                        print_stats();
                     }
+                    return DispatchResult::Ran;
+                }
+#endif
+            
+                // Handle user-registered commands, descending into groups
+                CommandArgsView command_args = args;
+                int depth = 0;
+                const CommandType* command = dispatcher_.resolve_command(command_args, depth);
+                if (!command) {
+#ifdef MCLI_ENABLE_STATS
+                    engine_stats_.unknown++;
+#endif
+                    return DispatchResult::NotFound;
                 }
 
-                // Build padding formatter
-                char fmt[32];
-                snprintf(fmt, sizeof(fmt), "  %%-%ds -- %%s\r\n", max_name_len);
+                if (command->kind == CommandKind::Group) {
+                    if (command_args.argc > 1) {
+                        io_.print("Subcommand \"");
+                        io_.print(command_args.argv[1]);
+                        io_.print("\" not found in \"");
+                        print_path(args, depth + 1);
+                        io_.println("\".");
+                        return DispatchResult::Failed;
+                    }
+                    print_group_help(args, depth + 1, *command);
+                    return DispatchResult::Ran;
+                }
+                if (!run_command(*command, args, depth + 1, command_args, deferrable, overflow)) {
+                    return DispatchResult::Failed;
+                }
+                return DispatchResult::Ran;
+            }
 
-                io_.println();
-                io_.println("Available commands:");
+            // Run one script line (len bytes, without its \n) and update result
+            void run_script_line(const char* text, size_t len, ScriptResult& result) {
+                result.lines++;
+                if (len > 0 && text[len - 1] == '\r') {
+                    len--;
+                }
+                size_t start = 0;
+                while (start < len && (text[start] == ' ' || text[start] == '\t')) {
+                    start++;
+                }
+                if (start == len || text[start] == '#') {
+                    return;
+                }
 
-                // Show built-in commands
-                io_.printf(fmt, "help", "Show available commands");
+                DispatchResult outcome = DispatchResult::Failed;
+                if (len < BufferSize) {
+                    // Scripts may live in flash, so tokenize a copy
+                    char line[BufferSize];
+                    memcpy(line, text, len);
+                    line[len] = '\0';
 
-                // Show user commands
-                if (command_count_ > 0) {
-                    for (size_t i = 0; i < command_count_; i++) {
-                        io_.printf(fmt, commands_[i].name, commands_[i].help);
+                    const char* argv[MaxArgs + 1];
+                    size_t lengths[MaxArgs];
+                    bool overflow = false;
+                    CommandArgsView args = parse_command_line(line, argv, lengths, overflow);
+                    if (args.argc == 0) {
+                        return;
+                    }
+                    outcome = dispatch_command(args, false, overflow);
+                    if (outcome == DispatchResult::NotFound) {
+                        io_.print("Command \"");
+                        io_.print(args.argv[0]);
+                        io_.println("\" not found.");
                     }
                 } else {
-                    io_.println("  (No additional commands registered)");
+                    io_.printf("Line longer than %u characters.\r\n", static_cast<unsigned>(BufferSize - 1));
+                }
+
+                if (outcome == DispatchResult::Ran) {
+                    result.commands++;
+                } else {
+                    result.ok = false;
+                    result.error_line = result.lines;
+                    io_.printf("Script stopped at line %lu.\r\n", static_cast<unsigned long>(result.lines));
                 }
-                io_.println();
             }
 
-            // Reset CLI state between connections
-            void reset_session() {
-                // Clear input buffer
-                memset(input_buffer_, 0, sizeof(input_buffer_));
-                input_pos_ = 0;
-                last_line_char_ = 0;
-                prompt_sent_ = false;
+            void finish_script(ScriptResult& result, uint32_t started) {
+                if (clock_) {
+                    result.elapsed_us = clock_() - started;
+                }
+                io_.flush();
             }
-            
-        private:
-            // Parse command line into argc/argv format
-            CommandArgs parse_command_line(const char* input) {
-                CommandArgs args;
-
-                // Work with a local copy for tokenization
-                char temp_buffer[CMD_BUFFER_SIZE];
-                strncpy(temp_buffer, input, CMD_BUFFER_SIZE-1);
-                temp_buffer[CMD_BUFFER_SIZE - 1] = '\0';
-
-                char* token = temp_buffer;
-                while (*token && args.argc < MAX_ARGS - 1) {
-                    // Skip leading spaces
-                    while (*token == ' ') token++;
-                    if (!*token) break;
-                
-                    // Token start
-                    // Copy token directly into args.argv[args.argc]
-                    char* dest = args.argv[args.argc];
-                    int char_count = 0;
-                    while (*token && *token != ' ' && char_count < MAX_ARG_LENGTH - 1) {
-                        *dest++ = *token++;
-                        char_count++;
-                    }
-                    *dest = '\0';
-                
-                    args.argc++;
-                
-                    // Skip trailing spaces
-                    while (*token == ' ') token++;
+
+            /**
+             * Run a resolved (non-group) command. full_args and path_depth are only
+             * used to print the command path in usage errors. A typed command on a
+             * line that overflowed MaxArgs is not run: its count is wrong.
+             * @return false if a typed command rejected its arguments
+             */
+            bool run_command(const CommandType& entry, const CommandArgsView& full_args, int path_depth,
+                             const CommandArgsView& command_args, bool deferrable, bool overflow) {
+#ifdef MCLI_ENABLE_STATS
+                uint32_t started = now_us();
+#endif
+                const CommandType* command = &entry;
+                bool usage_ok = true;
+                if (command->kind == CommandKind::Step && deferrable && !task_command_) {
+                    start_task(*command, command_args);
+                } else {
+                    detail::ScopedContextLock guard(handler_lock(*command));
+                    if (command->kind == CommandKind::Typed) {
+                        TypedArgsError error;
+                        // argc 0 matches no parameter count, so the thunk only fills in the usage
+                        CommandArgsView checked = command_args;
+                        if (overflow) {
+                            checked.argc = 0;
+                        }
+                        if (!command->execute_typed(checked, &context_, error)) {
+                            print_usage_error(full_args, path_depth, command_args, error);
+                            usage_ok = false;
+                        }
+                    } else if (command->kind == CommandKind::Step) {
+                        CommandTask task = {0, 0, false};
+                        while (command->execute_step(command_args, &context_, task) == StepResult::Continue) {
+                            task.step++;
+                        }
+                    } else if (command->kind == CommandKind::View) {
+                        command->execute_view(command_args, &context_);
+                    } else {
+                        command->execute(copy_command_args(command_args), &context_);
+                    }
                 }
-            
-                return args;
+#ifdef MCLI_ENABLE_STATS
+                record_stats(*command, now_us() - started, true);
+#endif
+                return usage_ok;
             }
 
-            // Get command input from user with echo and backspace support
-            CommandArgs get_command_input() {
-                // Read processing buffer
-                char read_buffer[32];
-                size_t buffer_len = 0;
+            // =========================================================================
+            // Framed RPC mode
+            // =========================================================================
+
+            // Collect COBS frames into input_buffer_ up to each 0x00 delimiter
+            void get_framed_input(const char* data, size_t len) {
+                for (size_t i = 0; i < len; i++) {
+                    if (data[i] != 0) {
+                        if (input_pos_ < BufferSize) {
+                            input_buffer_[input_pos_++] = data[i];
+                        } else {
+                            frame_overflow_ = true;
+                        }
+                        continue;
+                    }
+
+                    if (frame_overflow_) {
+                        send_frame_status(0, FrameStatus::BadFrame);
+                    } else if (input_pos_ > 0) {
+                        run_frame();
+                    }
+                    input_pos_ = 0;
+                    frame_overflow_ = false;
 
-                // Try to read available data (non-blocking)
-                buffer_len = io_.get_bytes(read_buffer, sizeof(read_buffer));
-                if (buffer_len == 0) {
-                    // No data available, return empty command
-                    return CommandArgs();
+                    if (!framed_mode_) {
+                        // FRAME_ID_EXIT: anything after it is console text again
+                        if (batch_mode_) {
+                            get_batch_input(data + i + 1, len - i - 1);
+                        } else {
+                            get_command_input(data + i + 1, len - i - 1);
+                        }
+                        return;
+                    }
                 }
+            }
 
-                // Process each character from the buffer
-                for (size_t i = 0; i < buffer_len; i++) {
-                    uint8_t in_char = 0;
+            void run_frame() {
+                uint8_t* frame = reinterpret_cast<uint8_t*>(input_buffer_);
+                size_t len = 0;
+                if (!cobs_decode(frame, input_pos_, len) || len < 3) {
+                    send_frame_status(0, FrameStatus::BadFrame);
+                    return;
+                }
+                uint8_t seq = frame[0];
+                uint16_t id = static_cast<uint16_t>(frame[1] | (frame[2] << 8));
 
-                    // Get the next character from the buffer
-                    in_char = read_buffer[i];
-                
-                    // Handle backspace
-                    if (in_char == 8 || in_char == 127) {
-                        if (input_pos_ > 0) {
-                            input_pos_--;
-                            input_buffer_[input_pos_] = '\0';
-                            io_.send_backspace();
+                // Unpack [len][bytes] arguments in place: shift each one down over
+                // its length byte and NUL-terminate it where the next one starts
+                const char* argv[MaxArgs + 1];
+                size_t lengths[MaxArgs];
+                int argc = 1;
+                size_t pos = 3;
+                while (pos < len) {
+                    size_t arg_len = frame[pos];
+                    if (argc >= MaxArgs || pos + 1 + arg_len > len) {
+                        send_frame_status(seq, FrameStatus::BadFrame);
+                        return;
+                    }
+                    memmove(input_buffer_ + pos, input_buffer_ + pos + 1, arg_len);
+                    input_buffer_[pos + arg_len] = '\0';
+                    argv[argc] = input_buffer_ + pos;
+                    lengths[argc] = arg_len;
+                    argc++;
+                    pos += arg_len + 1;
+                }
+                argv[argc] = nullptr;
+
+                CommandArgsView args;
+                args.argc = argc;
+                args.argv = argv;
+                args.lengths = lengths;
+
+                io_.framing_begin(seq);
+                FrameStatus status = FrameStatus::Ok;
+                if (id == FRAME_ID_EXIT) {
+                    io_.framing_end(status);
+                    set_framed_mode(false);
+                    return;
+                } else if (id == FRAME_ID_LOOKUP) {
+                    status = lookup_command_id(args);
+                } else {
+                    uint16_t remaining = id;
+                    const CommandType* command = DispatcherType::command_by_id(dispatcher_.commands(), dispatcher_.command_count(), remaining);
+                    if (!command || command->kind == CommandKind::Group) {
+                        status = FrameStatus::UnknownCommand;
+                    } else {
+                        // Handlers see the command name as argv[0] like on the console
+                        argv[0] = command->name;
+                        lengths[0] = strlen(command->name);
+                        if (!run_command(*command, args, 1, args, false, false)) {
+                            status = FrameStatus::UsageError;
                         }
-                        continue;
                     }
-                
-                    // Handle CRLF
-                    if (in_char == '\r' || in_char == '\n') {
-                        // If this is \n and we just processed \r, skip it
-                        if ((in_char == '\n') && (last_line_char_ == '\r')) {
-                            last_line_char_ = in_char;
-                            continue;
+                }
+                io_.framing_end(status);
+            }
+
+            void send_frame_status(uint8_t seq, FrameStatus status) {
+                io_.framing_begin(seq);
+                io_.framing_end(status);
+            }
+
+            // FRAME_ID_LOOKUP: the arguments are a command path, reply with its ID
+            FrameStatus lookup_command_id(const CommandArgsView& request) {
+                if (request.argc < 2) {
+                    return FrameStatus::UnknownCommand;
+                }
+                CommandArgsView path = request;
+                path.argc--;
+                path.argv++;
+                path.lengths++;
+
+                int depth = 0;
+                const CommandType* command = dispatcher_.resolve_command(path, depth);
+                uint16_t id = 0;
+                if (!command || path.argc > 1 || !DispatcherType::command_id(dispatcher_.commands(), dispatcher_.command_count(), command, id)) {
+                    return FrameStatus::UnknownCommand;
+                }
+                char reply[2] = {static_cast<char>(id & 0xFF), static_cast<char>(id >> 8)};
+                io_.put_bytes(reply, sizeof(reply));
+                return FrameStatus::Ok;
+            }
+
+            // Keep the arguments of a resumable command for its later steps
+            void start_task(const CommandType& command, const CommandArgsView& args) {
+                for (int i = 0; i < args.argc; i++) {
+                    task_argv_[i] = args.argv[i];
+                    task_lengths_[i] = args.lengths[i];
+                }
+                task_argv_[args.argc] = nullptr;
+                task_args_.argc = args.argc;
+                task_args_.argv = task_argv_;
+                task_args_.lengths = task_lengths_;
+
+                task_ = CommandTask{0, 0, false};
+                task_cancel_ = false;
+                task_command_ = &command;
+            }
+
+            // Run steps of the current resumable command for one time slice
+            void run_task_slice() {
+                // Input is held back while the command runs; only Ctrl-C is acted on
+                take_typeahead();
+
+                if (task_cancel_) {
+                    stop_task();
+                    io_.println("^C");
+                    finish_task();
+                } else {
+                    uint32_t start = clock_ ? clock_() : 0;
+                    do {
+                        if (task_output_blocked()) {
+                            // The link is backed up; try again next process_input()
+                            break;
                         }
-                        last_line_char_ = in_char;
+#ifdef MCLI_ENABLE_STATS
+                        uint32_t step_started = now_us();
+                        StepResult result = run_step();
+                        record_stats(*task_command_, now_us() - step_started, false);
+#else
+                        StepResult result = run_step();
+#endif
+                        task_.step++;
+                        if (result == StepResult::Done) {
+                            finish_task();
+                            break;
+                        }
+                    } while (clock_ && clock_() - start < task_slice_us_);
+                }
+                io_.flush();
+            }
 
-                        io_.println();
+            // readable_wait(), handing over to idle_wait() once the idle timeout passes
+            bool wait_for_input(uint32_t timeout_ms) {
+                if (typeahead_len_ > 0) {
+                    return true;
+                }
+                bool can_idle = idle_timeout_ms_ > 0 && input_pos_ == 0 &&
+                                escape_state_ == EscapeState::None && timeout_ms > idle_timeout_ms_;
+                if (!can_idle) {
+                    return io_.readable_wait(timeout_ms);
+                }
+                if (io_.readable_wait(idle_timeout_ms_)) {
+                    return true;
+                }
 
-                        // Only break if we've typed something
-                        if (input_pos_ > 0) {
-                            input_buffer_[input_pos_] = '\0';
-                            CommandArgs result = parse_command_line(input_buffer_);
+                idle_count_++;
+                io_.flush();
+                return io_.idle_wait(timeout_ms == WAIT_FOREVER ? WAIT_FOREVER : timeout_ms - idle_timeout_ms_);
+            }
 
-                            // Reset input buffer
-                            memset(input_buffer_, 0, sizeof(input_buffer_));
-                            input_pos_ = 0;
+            bool task_output_blocked() {
+                return task_output_reserve_ > 0 && io_.writable_space() < task_output_reserve_;
+            }
 
-                            return result;
-                        } 
+            /**
+             * Keep input that arrived behind a resumable command for when it ends.
+             * It goes ahead of anything already held, because it was read first.
+             */
+            void hold_input(const char* data, size_t len) {
+                size_t room = sizeof(typeahead_) - typeahead_len_;
+                if (len > room) {
+                    // Never happens: held input is at most one read, taken from here or from an empty buffer
+                    len = room;
+                }
+                memmove(typeahead_ + len, typeahead_, typeahead_len_);
+                memcpy(typeahead_, data, len);
+                typeahead_len_ += len;
+                watch_for_cancel();
+            }
 
-                        prompt_sent_ = false;
-                        
-                        continue;
+            /**
+             * Read input behind a running command, up to one hold's worth per
+             * slice. Reading goes on once the hold is full, dropping (and
+             * counting) what does not fit, so a Ctrl-C always gets through.
+             */
+            void take_typeahead() {
+                char chunk[32];
+                size_t budget = sizeof(typeahead_);
+                while (budget > 0) {
+                    size_t got = io_.get_bytes(chunk, (budget < sizeof(chunk)) ? budget : sizeof(chunk));
+                    if (got == 0) {
+                        break;
                     }
-                
-                    // Handle regular characters
-                    if (input_pos_ < CMD_BUFFER_SIZE - 1) {
-                        io_.put_byte(in_char);
-                        input_buffer_[input_pos_] = in_char;
-                        input_pos_++;
+                    budget -= got;
+
+                    const char* data = chunk;
+                    for (size_t i = got; i > 0; i--) {
+                        if (chunk[i - 1] == 0x03) {
+                            task_cancel_ = true;
+                            typeahead_len_ = 0;
+                            data = chunk + i;
+                            got -= i;
+                            break;
+                        }
                     }
+                    size_t room = sizeof(typeahead_) - typeahead_len_;
+                    size_t keep = (got < room) ? got : room;
+                    memcpy(typeahead_ + typeahead_len_, data, keep);
+                    typeahead_len_ += keep;
+#ifdef MCLI_ENABLE_STATS
+                    io_.io_stats().input_overflows += got - keep;
+#endif
                 }
-            
-                // No complete command yet
-                return CommandArgs();
             }
 
-            // Find and execute a command
-            bool dispatch_command(const CommandArgs& args) {
-                if (args.argc == 0) {
-                    return false;
+            // Ctrl-C in held input cancels the command and drops what was typed before it
+            void watch_for_cancel() {
+                for (size_t i = typeahead_len_; i > 0; i--) {
+                    if (typeahead_[i - 1] == 0x03) {
+                        task_cancel_ = true;
+                        typeahead_len_ -= i;
+                        memmove(typeahead_, typeahead_ + i, typeahead_len_);
+                        return;
+                    }
                 }
-            
-                // Handle built-in commands first
-                if (strcmp(args.argv[0], "help") == 0) {
+            }
+
+            // Input held back while a resumable command ran comes first, then the adapter's
+            size_t read_input(char* buffer, size_t max_len) {
+                if (typeahead_len_ == 0) {
+                    return io_.get_bytes(buffer, max_len);
+                }
+                size_t len = (typeahead_len_ < max_len) ? typeahead_len_ : max_len;
+                memcpy(buffer, typeahead_, len);
+                typeahead_len_ -= len;
+                memmove(typeahead_, typeahead_ + len, typeahead_len_);
+                return len;
+            }
+
+            // Give the running command its cancelled call
+            void stop_task() {
+                task_.cancelled = true;
+                run_step();
+            }
+
+            // One step of the running resumable command; the lock is held per step only
+            StepResult run_step() {
+                detail::ScopedContextLock guard(handler_lock(*task_command_));
+                return task_command_->execute_step(task_args_, &context_, task_);
+            }
+
+            // The lock a handler runs under: the session's, unless the command is reentrant
+            ContextLock* handler_lock(const CommandType& command) const {
+                return (command.flags & CMD_REENTRANT) ? nullptr : context_lock_;
+            }
+
+#ifdef MCLI_ENABLE_STATS
+            uint32_t now_us() const {
+                return clock_ ? clock_() : 0;
+            }
+
+            // Open-addressed slot for a command: its own, or the free one it would take
+            CommandStats* find_stats(const void* command) const {
+                if (!stats_) return nullptr;
+                size_t start = (reinterpret_cast<uintptr_t>(command) / sizeof(CommandType)) % stats_capacity_;
+                for (size_t probe = 0; probe < stats_capacity_; probe++) {
+                    CommandStats* slot = &stats_[(start + probe) % stats_capacity_];
+                    if (slot->command == command || !slot->command) {
+                        return slot;
+                    }
+                }
+                return nullptr;
+            }
+
+            // Resumable commands count one call but add the time of every step
+            void record_stats(const CommandType& command, uint32_t elapsed_us, bool new_call) {
+                CommandStats* slot = find_stats(&command);
+                if (!slot) {
+                    if (new_call) {
+                        engine_stats_.untracked++;
+                    }
+                    return;
+                }
+                slot->command = &command;
+                if (new_call) {
+                    slot->calls++;
+                }
+                slot->last_us = elapsed_us;
+                if (elapsed_us > slot->max_us) {
+                    slot->max_us = elapsed_us;
+                }
+                slot->total_us += elapsed_us;
+            }
+#endif
+
+            // Back to the prompt after a resumable command ends
+            void finish_task() {
+                task_command_ = nullptr;
+                input_buffer_[0] = '\0';
+                input_pos_ = 0;
+                show_prompt();
+            }
+
+            // Built-in help, optionally narrowed to a group: "help net wifi"
+            void run_help(const CommandArgsView& args) {
+                if (args.argc < 2) {
                     print_help();
-                    return true;
+                    return;
                 }
-            
-                // Handle user-registered commands
-                if (!command_count_) {
-                    return false;
+
+                CommandArgsView topic = args;
+                topic.argc--;
+                topic.argv++;
+                topic.lengths++;
+
+                CommandArgsView path = topic;
+                int depth = 0;
+                const CommandType* command = dispatcher_.resolve_command(path, depth);
+                if (!command || path.argc > 1) {
+                    io_.print("No help for \"");
+                    print_path(topic, topic.argc);
+                    io_.println("\".");
+                } else if (command->kind == CommandKind::Group) {
+                    print_group_help(topic, depth + 1, *command);
+                } else {
+                    io_.printf("  %s -- %s\r\n", command->name, command->help);
                 }
-            
-                for (size_t i = 0; i < command_count_; i++) {
-                    if (strcmp(args.argv[0], commands_[i].name) == 0) {
-                        commands_[i].execute(args, &context_);
-                        return true;
+            }
+
+            void print_group_help(const CommandArgsView& args, int depth, const CommandType& group) {
+                io_.println();
+                io_.print("Available \"");
+                print_path(args, depth);
+                io_.println("\" commands:");
+                print_command_list(group.children, group.child_count, false);
+                io_.println();
+            }
+
+            void print_command_list(const CommandType* table, size_t count, bool builtins) {
+                // Figure out the longest command name for padding
+#ifdef MCLI_ENABLE_STATS
+                size_t max_name_len = builtins ? strlen("stats") : 0;
+#else
+                size_t max_name_len = builtins ? strlen("help") : 0;
+#endif
+                for (size_t i = 0; i < count; i++) {
+                    size_t len = strlen(table[i].name);
+                    if (len > max_name_len) {
+                        max_name_len = len;
                     }
                 }
-            
-                return false;
+
+                const int width = static_cast<int>(max_name_len);
+
+                // Show built-in commands
+                if (builtins) {
+                    io_.printf("  %-*s -- %s\r\n", width, "help", "Show available commands");
+#ifdef MCLI_ENABLE_STATS
+                    io_.printf("  %-*s -- %s\r\n", width, "stats", "Show command statistics (stats reset to clear)");
+#endif
+                }
+
+                // Show user commands
+                if (count > 0) {
+                    for (size_t i = 0; i < count; i++) {
+                        io_.printf("  %-*s -- %s\r\n", width, table[i].name, table[i].help);
+                    }
+                } else {
+                    io_.println("  (No additional commands registered)");
+                }
+            }
+
+            // Print the first count tokens of a command line, e.g. "net wifi"
+            void print_path(const CommandArgsView& args, int count) {
+                for (int i = 0; i < count && i < args.argc; i++) {
+                    if (i > 0) io_.put_byte(' ');
+                    io_.print(args.argv[i]);
+                }
+            }
+
+            // Shared error path for typed commands
+            void print_usage_error(const CommandArgsView& full_args, int depth,
+                                   const CommandArgsView& args, const TypedArgsError& error) {
+                if (error.index > 0) {
+                    io_.printf("Invalid argument %d \"%s\": expected %s\r\n",
+                               error.index, args.argv[error.index], error.types[error.index - 1]);
+                }
+                io_.print("Usage: ");
+                print_path(full_args, depth);
+                for (int i = 0; i < error.type_count; i++) {
+                    io_.printf(" <%s>", error.types[i]);
+                }
+                io_.println();
             }
 
             // Member variables
-            CliIoInterface& io_;
+            IoType& io_;
             ContextType& context_;
-            const CommandDefinition<ContextType>* commands_;
-            size_t command_count_;
+            DispatcherType dispatcher_;
             const char* prompt_;
+            ContextLock* context_lock_ = nullptr;
 
             // Input parsing
-            char input_buffer_[CMD_BUFFER_SIZE];
+            char input_buffer_[BufferSize];
             size_t input_pos_ = 0;
             uint8_t last_line_char_ = 0;
             bool prompt_sent_ = false;
+            bool batch_mode_ = false;
+
+            // Framed RPC mode
+            bool framed_mode_ = false;
+            bool frame_overflow_ = false;
+
+            // Line editing and history
+            size_t cursor_ = 0;                 // Insert position, <= input_pos_
+            size_t history_pos_ = 0;            // 0 = new line, n = n-th newest entry shown
+            EscapeState escape_state_ = EscapeState::None;
+            uint8_t escape_param_ = 0;
+            detail::HistoryRing<HistoryBytes> history_;
+
+            // Resumable command in progress (arguments point into input_buffer_)
+            const CommandType* task_command_ = nullptr;
+            CommandTask task_ = {0, 0, false};
+            CommandArgsView task_args_ = {0, nullptr, nullptr};
+            const char* task_argv_[MaxArgs + 1];
+            size_t task_lengths_[MaxArgs];
+            bool task_cancel_ = false;
+            // Input that arrived behind it; at least one read (32 bytes), else one line.
+            // Input past that is dropped, except for Ctrl-C
+            char typeahead_[BufferSize > 32 ? BufferSize : 32];
+            size_t typeahead_len_ = 0;
+            uint32_t (*clock_)() = nullptr;
+            uint32_t task_slice_us_ = 0;
+            size_t task_output_reserve_ = 0;
+
+            // Idle policy for process_input_blocking()
+            uint32_t idle_timeout_ms_ = 0;
+            uint32_t idle_count_ = 0;
+
+#ifdef MCLI_ENABLE_STATS
+            CommandStats* stats_ = nullptr;
+            size_t stats_capacity_ = 0;
+            EngineStats engine_stats_ = EngineStats();
+#endif
     };
+
+    // The engine over the virtual interface: works with any CliIoInterface
+    template<typename ContextType,
+             size_t BufferSize = CMD_BUFFER_SIZE,
+             int MaxArgs = MAX_ARGS,
+             int MaxArgLength = MAX_ARG_LENGTH,
+             size_t HistoryBytes = 0>
+    using CliEngine = BasicCliEngine<CliIoInterface, ContextType, BufferSize, MaxArgs, MaxArgLength, HistoryBytes>;
 }
\ No newline at end of file
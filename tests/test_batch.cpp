@@ -0,0 +1,124 @@
+// test_batch.cpp
+// Batch mode: line splitting across terminators and reads, no echo or prompt
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char log[256];
+        int runs;
+    };
+
+    // Logs "<args>|" and prints "ok <args>"
+    void cmd_say(const mcli::CommandArgsView& args, Context* ctx) {
+        for (int i = 1; i < args.argc; i++) {
+            if (i > 1) strcat(ctx->log, " ");
+            strncat(ctx->log, args.argv[i], sizeof(ctx->log) - strlen(ctx->log) - 2);
+        }
+        strcat(ctx->log, "|");
+        ctx->io->printf("ok %d\r\n", args.argc - 1);
+        ctx->runs++;
+    }
+
+    void cmd_a(const mcli::CommandArgsView&, Context* ctx) {
+        ctx->runs++;
+    }
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"a", cmd_a, ""},
+        {"say", cmd_say, ""},
+    };
+
+    using Session = test::Session<Context>;
+
+    void test_find_line_end() {
+        char data[40];
+        const char terminators[] = {'\r', '\n'};
+        for (size_t pos = 0; pos < sizeof(data); pos++) {
+            for (char terminator : terminators) {
+                memset(data, 'x', sizeof(data));
+                data[pos] = terminator;
+                MCLI_CHECK(mcli::find_line_end(data, sizeof(data)) == pos);
+                // Only the first len bytes count
+                MCLI_CHECK(mcli::find_line_end(data, pos) == pos);
+            }
+        }
+        // Bytes that differ from CR or LF only in the high bit are not terminators
+        const char near[] = "\x8d\x8a\x0c\x0b\x1d\x1a\xff\x00";
+        MCLI_CHECK(mcli::find_line_end(near, sizeof(near) - 1) == sizeof(near) - 1);
+    }
+
+    void test_terminators() {
+        Session session(commands, true);
+        session.run("say 1\r\nsay 2\nsay 3\r\rsay 4 5\n\n\r\nsay 6\r");
+        MCLI_CHECK(strcmp(session.ctx.log, "1|2|3|4 5|6|") == 0);
+        // Only handler output: no echo and no prompt
+        MCLI_CHECK(strcmp(session.io.output(), "ok 1\r\nok 1\r\nok 1\r\nok 2\r\nok 1\r\n") == 0);
+    }
+
+    void test_split_reads() {
+        Session session(commands, true);
+        session.run("sa");
+        session.run("y one\r");
+        session.run("\nsay t");
+        session.run("wo\r\n");
+        MCLI_CHECK(strcmp(session.ctx.log, "one|two|") == 0);
+        MCLI_CHECK(session.ctx.runs == 2);
+    }
+
+    void test_escapes_and_overflow() {
+        Session session(commands, true);
+        // Cursor keys are dropped, not acted on
+        session.run("say a\x1b[Db\x1b[3~c\r");
+        MCLI_CHECK(strcmp(session.ctx.log, "abc|") == 0);
+
+        // A line past the buffer is cut short; the next one is unaffected
+        char input[300] = "say ";
+        memset(input + 4, 'x', 200);
+        strcpy(input + 204, "\rsay ok\r");
+        session.run(input);
+        MCLI_CHECK(session.ctx.runs == 3);
+        size_t len = strlen(session.ctx.log);
+        MCLI_CHECK(len > 4 && strcmp(session.ctx.log + len - 4, "|ok|") == 0);
+    }
+
+    void test_read_limit() {
+        static char input[600 + 1];
+        for (size_t i = 0; i < 600; i += 2) {
+            input[i] = 'a';
+            input[i + 1] = '\r';
+        }
+        Session session(commands, true);
+        session.io.set_input(input);
+        session.cli.process_input();
+        // Every complete line in the first BATCH_READ_LIMIT bytes runs in one call
+        MCLI_CHECK(session.ctx.runs == static_cast<int>(mcli::BATCH_READ_LIMIT / 2));
+        MCLI_CHECK(session.io.input_remaining() == 600 - mcli::BATCH_READ_LIMIT);
+        session.cli.process_input();
+        MCLI_CHECK(session.ctx.runs == 300);
+    }
+
+    void test_same_result_as_interactive() {
+        const char* input = "say 1\r\nsay 2 3\nsay\r";
+        Session batch(commands, true);
+        Session interactive(commands);
+        batch.run(input);
+        interactive.run(input);
+        MCLI_CHECK(strcmp(batch.ctx.log, interactive.ctx.log) == 0);
+        MCLI_CHECK_CONTAINS(interactive.io.output(), "mcli> ");
+        MCLI_CHECK(strstr(batch.io.output(), "mcli> ") == nullptr);
+    }
+
+}
+
+int main() {
+    test_find_line_end();
+    test_terminators();
+    test_split_reads();
+    test_escapes_and_overflow();
+    test_read_limit();
+    test_same_result_as_interactive();
+    return test::failures() == 0 ? 0 : 1;
+}
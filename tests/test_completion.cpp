@@ -0,0 +1,131 @@
+// test_completion.cpp
+// TAB completion from the command tree, on sorted and unsorted tables
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char line[64];
+    };
+
+    // Records the line the handler saw, arguments joined by single spaces
+    void cmd_log(const mcli::CommandArgsView& args, Context* ctx) {
+        ctx->line[0] = '\0';
+        for (int i = 0; i < args.argc; i++) {
+            if (i > 0) strcat(ctx->line, " ");
+            strcat(ctx->line, args.argv[i]);
+        }
+    }
+
+    const mcli::CommandDefinition<Context> net_sorted[] = {
+        {"scan", cmd_log, ""},
+        {"status", cmd_log, ""},
+        {"stop", cmd_log, ""},
+    };
+
+    const mcli::CommandDefinition<Context> sorted[] = {
+        {"led", cmd_log, ""},
+        {"net", net_sorted, ""},
+        {"reboot", cmd_log, ""},
+        {"reset", cmd_log, ""},
+    };
+
+    const mcli::CommandDefinition<Context> net_unsorted[] = {
+        {"stop", cmd_log, ""},
+        {"scan", cmd_log, ""},
+        {"status", cmd_log, ""},
+    };
+
+    const mcli::CommandDefinition<Context> unsorted[] = {
+        {"reset", cmd_log, ""},
+        {"net", net_unsorted, ""},
+        {"reboot", cmd_log, ""},
+        {"led", cmd_log, ""},
+    };
+
+    using Session = test::Session<Context>;
+
+    // Type input (ending in Enter); returns the line the handler saw
+    template<typename Table>
+    const char* complete(const Table& commands, const char* input, bool expect_sorted) {
+        static char line[64];
+        Session session(commands);
+        MCLI_CHECK(session.cli.dispatcher().sorted() == expect_sorted);
+        session.run(input);
+        strcpy(line, session.ctx.line);
+        return line;
+    }
+
+    template<typename Table>
+    void test_unique_matches(const Table& commands, bool expect_sorted) {
+        MCLI_CHECK(strcmp(complete(commands, "le\t\r", expect_sorted), "led") == 0);
+        MCLI_CHECK(strcmp(complete(commands, "res\t\r", expect_sorted), "reset") == 0);
+        MCLI_CHECK(strcmp(complete(commands, "net sc\t\r", expect_sorted), "scan") == 0);
+        MCLI_CHECK(strcmp(complete(commands, "  net   sto\t\r", expect_sorted), "stop") == 0);
+        // The completed word is followed by a space, ready for the next one
+        MCLI_CHECK(strcmp(complete(commands, "n\tsta\t\r", expect_sorted), "status") == 0);
+    }
+
+    // Candidates are listed in table order, so check each one
+    void check_listed(const char* output, const char* const* names, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            char entry[16];
+            snprintf(entry, sizeof(entry), "%s  ", names[i]);
+            MCLI_CHECK_CONTAINS(output, entry);
+        }
+    }
+
+    template<typename Table>
+    void test_candidates(const Table& commands) {
+        Session session(commands);
+        session.run("re\t");
+        const char* restarts[] = {"reboot", "reset"};
+        check_listed(session.io.output(), restarts, 2);
+        MCLI_CHECK(strstr(session.io.output(), "led  ") == nullptr);
+        // The prompt and the line come back below the list
+        MCLI_CHECK_CONTAINS(session.io.output(), "  \r\n\x1b[1mmcli> \x1b[0mre");
+
+        session.io.clear_output();
+        session.run("\x7f\x7f" "net s\t");
+        const char* net[] = {"scan", "status", "stop"};
+        check_listed(session.io.output(), net, 3);
+
+        // Extends to the common prefix ("re") without listing, then lists
+        session.io.clear_output();
+        session.run("\x7f\x7f\x7f\x7f\x7f" "r\t");
+        MCLI_CHECK(strstr(session.io.output(), "reset  ") == nullptr);
+        MCLI_CHECK(session.io.output()[session.io.output_length() - 1] == 'e');
+        session.run("\t");
+        check_listed(session.io.output(), restarts, 2);
+    }
+
+    void test_builtins_and_bell() {
+        Session session(sorted);
+        session.run("he\t");
+        MCLI_CHECK(strcmp(session.io.output() + strlen(session.io.output()) - 3, "lp ") == 0);
+
+        session.io.clear_output();
+        session.run("\r" "help ne\t");
+        MCLI_CHECK(strcmp(session.io.output() + strlen(session.io.output()) - 3, "et ") == 0);
+
+        // No match, an argument of a command, "help" past the first word, and mid-line
+        const char* bells[] = {"\rzz\t", "\rled o\t", "\rnet help\t", "\rled\x1b[D\t"};
+        for (const char* input : bells) {
+            session.io.clear_output();
+            session.run(input);
+            MCLI_CHECK(strchr(session.io.output(), '\a') != nullptr);
+        }
+    }
+
+}
+
+int main() {
+    test_unique_matches(sorted, true);
+    test_unique_matches(unsorted, false);
+    test_candidates(sorted);
+    test_candidates(unsorted);
+    test_builtins_and_bell();
+    return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+// test_framed.cpp
+// COBS framing and framed RPC dispatch, entered and left from the text console
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+    };
+
+    void set_led(Context* ctx, unsigned id) {
+        ctx->io->printf("ran led %u\r\n", id);
+    }
+
+    void cmd_ping(const mcli::CommandArgsView&, Context* ctx) {
+        ctx->io->print("pong");
+    }
+
+    void cmd_say(const mcli::CommandArgsView& args, Context* ctx) {
+        for (int i = 1; i < args.argc; i++) {
+            ctx->io->print(args.argv[i]);
+        }
+    }
+
+    const mcli::CommandDefinition<Context> net_commands[] = {
+        {"ping", cmd_ping, ""},
+    };
+
+    // IDs: led 1, net 2, net ping 3, say 4
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"led", MCLI_TYPED(set_led), ""},
+        {"net", net_commands, ""},
+        {"say", cmd_say, ""},
+    };
+
+    using Session = test::Session<Context>;
+
+    // A request as the host sends it: COBS-encoded, then the 0x00 delimiter
+    size_t request(char* out, uint8_t seq, uint16_t id, const char* const* args = nullptr, int argc = 0) {
+        uint8_t raw[128] = {seq, static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8)};
+        size_t len = 3;
+        for (int i = 0; i < argc; i++) {
+            size_t arg_len = strlen(args[i]);
+            raw[len++] = static_cast<uint8_t>(arg_len);
+            memcpy(raw + len, args[i], arg_len);
+            len += arg_len;
+        }
+        size_t encoded = mcli::cobs_encode(raw, len, reinterpret_cast<uint8_t*>(out));
+        out[encoded++] = '\0';
+        return encoded;
+    }
+
+    struct Reply {
+        uint8_t seq;
+        uint8_t type;
+        char payload[80];
+        size_t len;
+    };
+
+    // Decode the frames in data, which must start on a frame boundary
+    size_t replies(const char* data, size_t len, Reply* out, size_t max) {
+        size_t count = 0;
+        size_t start = 0;
+        for (size_t i = 0; i < len && count < max; i++) {
+            if (data[i] != '\0') {
+                continue;
+            }
+            Reply& reply = out[count];
+            size_t frame_len = i - start;
+            size_t decoded = 0;
+            start = i + 1;
+            if (frame_len > sizeof(reply.payload)) {
+                continue;
+            }
+            uint8_t* frame = reinterpret_cast<uint8_t*>(reply.payload);
+            memcpy(frame, data + i - frame_len, frame_len);
+            if (!mcli::cobs_decode(frame, frame_len, decoded) || decoded < 2) {
+                continue;
+            }
+            reply.seq = frame[0];
+            reply.type = frame[1];
+            reply.len = decoded - 2;
+            memmove(reply.payload, reply.payload + 2, reply.len);
+            reply.payload[reply.len] = '\0';
+            count++;
+        }
+        return count;
+    }
+
+    bool is_status(const Reply& reply, uint8_t seq, mcli::FrameStatus status) {
+        return reply.type == mcli::FRAME_STATUS && reply.seq == seq && reply.len == 1 &&
+               reply.payload[0] == static_cast<char>(status);
+    }
+
+    void test_cobs_round_trip() {
+        uint8_t data[600];
+        for (size_t i = 0; i < sizeof(data); i++) {
+            data[i] = (i % 97 == 0) ? 0 : static_cast<uint8_t>(i);
+        }
+        // Runs of more than 254 non-zero bytes need extra code bytes
+        memset(data + 300, 0x55, 280);
+
+        uint8_t encoded[sizeof(data) + sizeof(data) / 254 + 1];
+        size_t len = mcli::cobs_encode(data, sizeof(data), encoded);
+        MCLI_CHECK(memchr(encoded, 0, len) == nullptr);
+
+        size_t decoded = 0;
+        MCLI_CHECK(mcli::cobs_decode(encoded, len, decoded));
+        MCLI_CHECK(decoded == sizeof(data));
+        MCLI_CHECK(memcmp(encoded, data, sizeof(data)) == 0);
+
+        uint8_t truncated[] = {0x05, 'a', 'b'};
+        MCLI_CHECK(!mcli::cobs_decode(truncated, sizeof(truncated), decoded));
+    }
+
+    void test_dispatch_by_id() {
+        Session session(commands);
+        MCLI_CHECK(session.cli.set_framed_mode(true));
+        Reply ack[2];
+        MCLI_CHECK(replies(session.io.output(), session.io.output_length(), ack, 2) == 1);
+        MCLI_CHECK(is_status(ack[0], 0, mcli::FrameStatus::Ok));
+        session.io.clear_output();
+
+        char input[256];
+        size_t len = 0;
+        const char* led_args[] = {"7"};
+        len += request(input + len, 1, 1, led_args, 1);
+        len += request(input + len, 2, 3);
+        const char* bad_args[] = {"seven"};
+        len += request(input + len, 3, 1, bad_args, 1);
+        len += request(input + len, 4, 2);
+        len += request(input + len, 5, 99);
+        session.run(input, len);
+
+        Reply out[16];
+        size_t count = replies(session.io.output(), session.io.output_length(), out, 16);
+        MCLI_CHECK(count >= 7);
+        MCLI_CHECK(out[0].type == mcli::FRAME_DATA && strcmp(out[0].payload, "ran led 7\r\n") == 0);
+        MCLI_CHECK(is_status(out[1], 1, mcli::FrameStatus::Ok));
+        MCLI_CHECK(out[2].seq == 2 && strcmp(out[2].payload, "pong") == 0);
+        MCLI_CHECK(is_status(out[3], 2, mcli::FrameStatus::Ok));
+
+        // The usage message travels in data frames ahead of the status
+        size_t i = 4;
+        while (i < count && out[i].type == mcli::FRAME_DATA) {
+            i++;
+        }
+        MCLI_CHECK(i < count && is_status(out[i], 3, mcli::FrameStatus::UsageError));
+        MCLI_CHECK(i + 1 < count && is_status(out[i + 1], 4, mcli::FrameStatus::UnknownCommand));
+        MCLI_CHECK(i + 2 < count && is_status(out[i + 2], 5, mcli::FrameStatus::UnknownCommand));
+    }
+
+    void test_lookup_and_bad_frames() {
+        Session session(commands);
+        session.cli.set_framed_mode(true);
+        session.io.clear_output();
+
+        char input[128];
+        size_t len = 0;
+        const char* path[] = {"net", "ping"};
+        len += request(input + len, 1, mcli::FRAME_ID_LOOKUP, path, 2);
+        // Argument length runs past the end of the frame
+        uint8_t raw[] = {2, 4, 0, 9, 'x'};
+        len += mcli::cobs_encode(raw, sizeof(raw), reinterpret_cast<uint8_t*>(input + len));
+        input[len++] = '\0';
+        session.run(input, len);
+
+        Reply out[4];
+        MCLI_CHECK(replies(session.io.output(), session.io.output_length(), out, 4) == 3);
+        MCLI_CHECK(out[0].type == mcli::FRAME_DATA && out[0].len == 2);
+        MCLI_CHECK(out[0].payload[0] == 3 && out[0].payload[1] == 0);
+        MCLI_CHECK(is_status(out[1], 1, mcli::FrameStatus::Ok));
+        MCLI_CHECK(is_status(out[2], 2, mcli::FrameStatus::BadFrame));
+    }
+
+    // Console text, FRAMED_MODE_SEQUENCE, a frame, the exit frame, then text again
+    void test_enter_and_leave(bool batch) {
+        Session session(commands, batch);
+        char input[128];
+        size_t len = 0;
+        const char* say_args[] = {"hi"};
+        len += request(input + len, 1, 4, say_args, 1);
+        len += request(input + len, 2, mcli::FRAME_ID_EXIT);
+        memcpy(input + len, "led 5\r", 6);
+        len += 6;
+
+        session.run(mcli::FRAMED_MODE_SEQUENCE);
+        MCLI_CHECK(session.cli.framed_mode());
+        session.io.clear_output();
+        session.run(input, len);
+        MCLI_CHECK(!session.cli.framed_mode());
+
+        const char* output = session.io.output();
+        size_t output_len = session.io.output_length();
+        Reply out[4];
+        MCLI_CHECK(replies(output, output_len, out, 4) == 3);
+        MCLI_CHECK(strcmp(out[0].payload, "hi") == 0);
+        MCLI_CHECK(is_status(out[2], 2, mcli::FrameStatus::Ok));
+
+        // Text after the last frame: batch mode has no echo, so output comes first
+        size_t text = output_len;
+        while (text > 0 && output[text - 1] != '\0') {
+            text--;
+        }
+        if (batch) {
+            MCLI_CHECK(strncmp(output + text, "ran led 5\r\n", 11) == 0);
+        } else {
+            MCLI_CHECK_CONTAINS(output + text, "led 5\r\nran led 5\r\n");
+        }
+    }
+
+}
+
+int main() {
+    test_cobs_round_trip();
+    test_dispatch_by_id();
+    test_lookup_and_bad_frames();
+    test_enter_and_leave(false);
+    test_enter_and_leave(true);
+    return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// test_groups.cpp
+// Nested command groups: dispatch, group listings, help topics and errors
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char line[64];
+        int joined;
+    };
+
+    // Records the line the handler saw, arguments joined by single spaces
+    void cmd_log(const mcli::CommandArgsView& args, Context* ctx) {
+        ctx->line[0] = '\0';
+        for (int i = 0; i < args.argc; i++) {
+            if (i > 0) strcat(ctx->line, " ");
+            strcat(ctx->line, args.argv[i]);
+        }
+    }
+
+    void wifi_join(Context* ctx, int channel) {
+        ctx->joined = channel;
+    }
+
+    const mcli::CommandDefinition<Context> wifi_commands[] = {
+        {"join", MCLI_TYPED(wifi_join), "Join on a channel"},
+        {"scan", cmd_log, "Scan for networks"},
+        {"status", cmd_log, "Show connection status"},
+    };
+
+    const mcli::CommandDefinition<Context> net_commands[] = {
+        {"help", cmd_log, "Group-level entry, not the built-in"},
+        {"wifi", wifi_commands, "WiFi commands"},
+    };
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"led", cmd_log, "Toggle LED state"},
+        {"net", net_commands, "Network commands"},
+    };
+
+    using Session = test::Session<Context>;
+
+    void test_dispatch() {
+        Session session(commands);
+        session.run("net wifi status now\r");
+        // Handlers in a group see their own name as argv[0]
+        MCLI_CHECK(strcmp(session.ctx.line, "status now") == 0);
+
+        session.run("net help me\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "help me") == 0);
+
+        session.run("net wifi join 6\r");
+        MCLI_CHECK(session.ctx.joined == 6);
+
+        MCLI_CHECK(session.cli.execute_command("net wifi scan"));
+        MCLI_CHECK(strcmp(session.ctx.line, "scan") == 0);
+        MCLI_CHECK(session.cli.execute_command("net"));
+    }
+
+    void test_group_listings() {
+        Session session(commands);
+        session.run("net wifi\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Available \"net wifi\" commands:\r\n");
+        MCLI_CHECK_CONTAINS(session.io.output(), "  status -- Show connection status\r\n");
+        MCLI_CHECK(strstr(session.io.output(), "Toggle LED") == nullptr);
+
+        session.io.clear_output();
+        session.run("help net\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Available \"net\" commands:\r\n");
+        MCLI_CHECK_CONTAINS(session.io.output(), "wifi -- WiFi commands");
+        MCLI_CHECK(strstr(session.io.output(), "scan") == nullptr);
+
+        session.io.clear_output();
+        session.run("help net wifi scan\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "  scan -- Scan for networks\r\n");
+
+        // The top-level listing shows groups, not their entries
+        session.io.clear_output();
+        session.run("help\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "net");
+        MCLI_CHECK(strstr(session.io.output(), "status") == nullptr);
+    }
+
+    void test_errors() {
+        Session session(commands);
+        session.run("net bogus\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Subcommand \"bogus\" not found in \"net\".\r\n");
+
+        session.io.clear_output();
+        session.run("net wifi bogus 1\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Subcommand \"bogus\" not found in \"net wifi\".\r\n");
+        MCLI_CHECK(!session.cli.execute_command("net wifi bogus"));
+
+        session.io.clear_output();
+        session.run("help net bogus\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "No help for \"net bogus\".\r\n");
+
+        // Usage errors name the whole path
+        session.io.clear_output();
+        session.run("net wifi join six\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Usage: net wifi join <int>\r\n");
+        MCLI_CHECK(session.ctx.joined == 0);
+
+        // Groups are not commands of their own at the top level: "wifi" lives in "net"
+        session.io.clear_output();
+        session.run("wifi scan\r");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Command \"wifi\" not found.");
+    }
+
+}
+
+int main() {
+    test_dispatch();
+    test_group_listings();
+    test_errors();
+    return test::failures() == 0 ? 0 : 1;
+}
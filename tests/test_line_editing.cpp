@@ -0,0 +1,117 @@
+// test_line_editing.cpp
+// VT100 line editing and the packed history ring with arrow-key recall
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char line[64];
+        int runs;
+    };
+
+    // Records the line the handler saw, arguments joined by single spaces
+    void cmd_say(const mcli::CommandArgsView& args, Context* ctx) {
+        ctx->line[0] = '\0';
+        for (int i = 0; i < args.argc; i++) {
+            if (i > 0) strcat(ctx->line, " ");
+            strcat(ctx->line, args.argv[i]);
+        }
+        ctx->runs++;
+    }
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"say", cmd_say, ""},
+    };
+
+    using HistoryEngine = mcli::CliEngine<Context, mcli::CMD_BUFFER_SIZE, mcli::MAX_ARGS, mcli::MAX_ARG_LENGTH, 64>;
+    using Session = test::Session<Context, HistoryEngine>;
+
+    const char* get(const mcli::detail::HistoryRing<16>& ring, size_t age) {
+        static char out[17];
+        size_t len = ring.get(age, out, 16);
+        out[len] = '\0';
+        return out;
+    }
+
+    void test_ring() {
+        mcli::detail::HistoryRing<16> ring;
+        ring.push("", 0);
+        ring.push("one", 3);
+        ring.push("one", 3);   // Repeat of the newest: skipped
+        ring.push("two", 3);
+        MCLI_CHECK(ring.count() == 2);
+        MCLI_CHECK(strcmp(get(ring, 0), "two") == 0);
+        MCLI_CHECK(strcmp(get(ring, 1), "one") == 0);
+        MCLI_CHECK(ring.get(2, nullptr, 0) == 0);
+
+        // 5 + 5 + 7 bytes: "one" goes to make room, and the entry wraps around
+        ring.push("three", 5);
+        MCLI_CHECK(ring.count() == 2);
+        MCLI_CHECK(strcmp(get(ring, 0), "three") == 0);
+        MCLI_CHECK(strcmp(get(ring, 1), "two") == 0);
+
+        ring.push("fourteen-chars", 14);   // 16 bytes: takes the whole ring
+        MCLI_CHECK(ring.count() == 1);
+        MCLI_CHECK(strcmp(get(ring, 0), "fourteen-chars") == 0);
+        ring.push("fifteen-chars..", 15);  // Cannot fit: skipped
+        MCLI_CHECK(ring.count() == 1);
+    }
+
+    void test_edit_mid_line() {
+        Session session(commands);
+        // Left and insert; Home, insert, left and Delete (ESC[3~) it again; End and backspace
+        session.run("say ac\x1b[D" "b" "\x1b[H" "x\x1b[D\x1b[3~" "\x1b[F" "\x7f" "d\r");
+        MCLI_CHECK(session.ctx.runs == 1);
+        MCLI_CHECK(strcmp(session.ctx.line, "say abd") == 0);
+
+        // Backspace in the middle, VT220 Home/End (ESC[1~, ESC[4~) and SS3 cursor keys
+        session.run("say xyz\x1bOD\b\x1b[1~\x1b[4~!\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "say xz!") == 0);
+    }
+
+    void test_backspace_at_start_and_long_moves() {
+        Session session(commands);
+        session.run("\b\x7fsay 1234567\x1b[H\x1b[F\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "say 1234567") == 0);
+        // Moves of more than three columns use one CSI sequence each way
+        MCLI_CHECK_CONTAINS(session.io.output(), "\x1b[11D");
+        MCLI_CHECK_CONTAINS(session.io.output(), "\x1b[11C");
+    }
+
+    void test_recall() {
+        Session session(commands);
+        session.run("say one\rsay two\r");
+        session.run("\x1b[A\x1b[A\r");
+        MCLI_CHECK(session.ctx.runs == 3);
+        MCLI_CHECK(strcmp(session.ctx.line, "say one") == 0);
+
+        // Up past the oldest stays there; down past the newest gives an empty line
+        session.run("\x1b[A\x1b[A\x1b[A\x1b[A\x1b[B\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "say two") == 0);
+        session.run("\x1b[A\x1b[B say three\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "say three") == 0);
+
+        // A recalled line can be edited before it runs
+        session.run("\x1b[A\x7f\x7f\x7f\x7f\x7f" "four\r");
+        MCLI_CHECK(strcmp(session.ctx.line, "say four") == 0);
+        MCLI_CHECK(session.ctx.runs == 6);
+    }
+
+    void test_no_history_engine() {
+        test::Session<Context> session(commands);
+        session.run("say one\r\x1b[A\r");
+        MCLI_CHECK(session.ctx.runs == 1);
+    }
+
+}
+
+int main() {
+    test_ring();
+    test_edit_mid_line();
+    test_backspace_at_start_and_long_moves();
+    test_recall();
+    test_no_history_engine();
+    return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// test_main.h
+// Minimal check helpers and a shared fixture for the MCLI host tests: each test is a function, main() runs them
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+
+#include "mcli.h"
+#include "mcli_framed_io.h"
+#include "mcli_memory_loopback.h"
+
+namespace test {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const char* expr) {
+        printf("%s:%d: check failed: %s\n", file, line, expr);
+        failures()++;
+    }
+
+    /**
+     * An engine on a MemoryLoopbackIo, through a FramedIo so framed mode works
+     * too (the decorator passes text through until then). The context is
+     * value-initialized and its io member pointed at the engine's adapter, so
+     * handlers print through it.
+     *
+     *   test::Session<Context> session(commands);
+     *   session.run("led on\r");
+     *   MCLI_CHECK_CONTAINS(session.io.output(), "LED on");
+     */
+    template<typename Context, typename Engine = mcli::CliEngine<Context>>
+    struct Session {
+        MemoryLoopbackIo<4096> io;
+        FramedIo<> framed;
+        Context ctx;
+        Engine cli;
+
+        template<typename Table>
+        explicit Session(const Table& commands, bool batch = false) : framed(io), ctx(), cli(framed, ctx, commands) {
+            ctx.io = &framed;
+            cli.set_batch_mode(batch);
+        }
+
+        // Feed input, then run until the engine has nothing left to do
+        void run(const char* input, size_t len) {
+            io.set_input(input, len);
+            for (int i = 0; i < 50; i++) {
+                cli.process_input();
+            }
+        }
+
+        void run(const char* input) {
+            run(input, strlen(input));
+        }
+    };
+
+}
+
+#define MCLI_CHECK(expr) do { if (!(expr)) test::fail(__FILE__, __LINE__, #expr); } while (0)
+#define MCLI_CHECK_CONTAINS(haystack, needle) MCLI_CHECK(strstr((haystack), (needle)) != nullptr)
@@ -0,0 +1,48 @@
+// test_ram_log.cpp
+// RamLogSink starts empty by default and keeps its ring across a reset when asked to
+
+#include <new>
+
+#include "mcli.h"
+#include "mcli_ram_log.h"
+#include "test_main.h"
+
+namespace {
+
+    using Log = RamLogSink<16>;
+
+    // Stands in for no-init memory: survives "resets", starts as garbage
+    alignas(Log) unsigned char storage[sizeof(Log)];
+
+    void test_default_starts_empty() {
+        memset(storage, 0xA5, sizeof(storage));
+        Log* log = new (storage) Log();
+        MCLI_CHECK(!log->restored());
+        MCLI_CHECK(log->length() == 0);
+        log->~Log();
+    }
+
+    void test_restore_after_reset() {
+        memset(storage, 0xA5, sizeof(storage));
+        Log* log = new (storage) Log(RAM_LOG_RESTORE);
+        MCLI_CHECK(!log->restored()); // Garbage header: starts over
+        MCLI_CHECK(log->length() == 0);
+        log->print("before the reset, wrapped");
+
+        // Reset: constructed again over the same memory
+        log = new (storage) Log(RAM_LOG_RESTORE);
+        MCLI_CHECK(log->restored());
+        char out[16];
+        size_t len = log->copy_to(out, sizeof(out));
+        MCLI_CHECK(len == 16);
+        MCLI_CHECK(memcmp(out, "e reset, wrapped", 16) == 0);
+        log->~Log();
+    }
+
+}
+
+int main() {
+    test_default_starts_empty();
+    test_restore_after_reset();
+    return test::failures() == 0 ? 0 : 1;
+}
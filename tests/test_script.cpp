@@ -0,0 +1,152 @@
+// test_script.cpp
+// execute_command() results, and scripts run from memory and from a ScriptSource
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        int runs;
+        unsigned value;
+    };
+
+    void cmd_mark(const mcli::CommandArgsView& args, Context* ctx) {
+        if (args.argc == 2 && strcmp(args.argv[1], "end") == 0) {
+            ctx->runs++;
+        }
+    }
+
+    void set_value(Context* ctx, unsigned value) {
+        ctx->value = value;
+    }
+
+    const mcli::CommandDefinition<Context> group_commands[] = {
+        {"mark", cmd_mark, ""},
+    };
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"grp", group_commands, ""},
+        {"mark", cmd_mark, ""},
+        {"set", MCLI_TYPED(set_value), ""},
+    };
+
+    // Hands the script out a few bytes per read, like a slow file
+    class StringSource : public mcli::ScriptSource {
+        public:
+            StringSource(const char* text, size_t step) : text_(text), len_(strlen(text)), step_(step) {}
+
+            size_t read(char* buffer, size_t max_len) override {
+                size_t n = len_ < max_len ? len_ : max_len;
+                n = n < step_ ? n : step_;
+                memcpy(buffer, text_, n);
+                text_ += n;
+                len_ -= n;
+                return n;
+            }
+
+        private:
+            const char* text_;
+            size_t len_;
+            size_t step_;
+    };
+
+    // "mark", spaces up to length characters, "end", then the line ending
+    void make_line(char* out, size_t length, const char* ending) {
+        memcpy(out, "mark", 4);
+        memset(out + 4, ' ', length - 7);
+        memcpy(out + length - 3, "end", 3);
+        strcpy(out + length, ending);
+    }
+
+    using Session = test::Session<Context>;
+
+    void test_execute_command_result() {
+        Session session(commands);
+        MCLI_CHECK(session.cli.execute_command("mark end"));
+        MCLI_CHECK(session.cli.execute_command("grp mark end"));
+        MCLI_CHECK(session.cli.execute_command("set 0x10"));
+        MCLI_CHECK(session.ctx.value == 16);
+        MCLI_CHECK(session.ctx.runs == 2);
+
+        MCLI_CHECK(!session.cli.execute_command("nope"));
+        MCLI_CHECK(!session.cli.execute_command(""));
+        MCLI_CHECK(!session.cli.execute_command("grp nope"));
+        MCLI_CHECK(!session.cli.execute_command("set sixteen"));
+        MCLI_CHECK(!session.cli.execute_command("set"));
+        MCLI_CHECK(session.ctx.value == 16);
+    }
+
+    void test_script_stops_at_failure() {
+        const char script[] =
+            "# comment\n"
+            "\n"
+            "  mark end\r\n"
+            "set 3\n"
+            "set three\n"
+            "mark end\n";
+        Session memory(commands);
+        mcli::ScriptResult result = memory.cli.execute_script(script, sizeof(script) - 1);
+        MCLI_CHECK(!result.ok);
+        MCLI_CHECK(result.lines == 5);
+        MCLI_CHECK(result.commands == 2);
+        MCLI_CHECK(result.error_line == 5);
+        MCLI_CHECK(memory.ctx.runs == 1);
+        MCLI_CHECK(memory.ctx.value == 3);
+
+        Session streamed(commands);
+        StringSource source(script, 5);
+        mcli::ScriptResult from_source = streamed.cli.execute_script(source);
+        MCLI_CHECK(from_source.error_line == 5);
+        MCLI_CHECK(from_source.commands == 2);
+    }
+
+    void test_longest_line(const char* ending) {
+        const size_t longest = mcli::CMD_BUFFER_SIZE - 1;
+        char script[mcli::CMD_BUFFER_SIZE + 16];
+        make_line(script, longest, ending);
+        strcat(script, "mark end\n");
+
+        Session memory(commands);
+        mcli::ScriptResult from_memory = memory.cli.execute_script(script, strlen(script));
+        MCLI_CHECK(from_memory.ok);
+        MCLI_CHECK(memory.ctx.runs == 2);
+
+        const size_t steps[] = {1, 7, sizeof(script)};
+        for (size_t step : steps) {
+            Session streamed(commands);
+            StringSource source(script, step);
+            mcli::ScriptResult from_source = streamed.cli.execute_script(source);
+            MCLI_CHECK(from_source.ok);
+            MCLI_CHECK(from_source.commands == 2);
+            MCLI_CHECK(from_source.lines == from_memory.lines);
+            MCLI_CHECK(streamed.ctx.runs == 2);
+        }
+    }
+
+    void test_line_too_long(const char* ending) {
+        char script[mcli::CMD_BUFFER_SIZE + 8];
+        make_line(script, mcli::CMD_BUFFER_SIZE, ending);
+
+        Session memory(commands);
+        MCLI_CHECK(!memory.cli.execute_script(script, strlen(script)).ok);
+
+        Session streamed(commands);
+        StringSource source(script, 16);
+        mcli::ScriptResult result = streamed.cli.execute_script(source);
+        MCLI_CHECK(!result.ok);
+        MCLI_CHECK(result.error_line == 1);
+        MCLI_CHECK_CONTAINS(streamed.io.output(), "Line longer");
+    }
+
+}
+
+int main() {
+    test_execute_command_result();
+    test_script_stops_at_failure();
+    test_longest_line("\r\n");
+    test_longest_line("\n");
+    test_line_too_long("\r\n");
+    test_line_too_long("\n");
+    return test::failures() == 0 ? 0 : 1;
+}
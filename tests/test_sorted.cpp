@@ -0,0 +1,104 @@
+// test_sorted.cpp
+// Compile-time table checks and binary-search lookup on sorted command tables
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char last[8];
+    };
+
+    void cmd_name(const mcli::CommandArgsView& args, Context* ctx) {
+        strcpy(ctx->last, args.argv[0]);
+    }
+
+    constexpr mcli::CommandDefinition<Context> help_child[] = {
+        {"help", cmd_name, ""},
+        {"list", cmd_name, ""},
+    };
+    constexpr mcli::CommandDefinition<Context> unsorted_child[] = {
+        {"list", cmd_name, ""},
+        {"add", cmd_name, ""},
+    };
+
+#define ENTRY(name) {name, cmd_name, ""}
+    constexpr mcli::CommandDefinition<Context> alphabet[] = {
+        ENTRY("a"), ENTRY("b"), ENTRY("c"), ENTRY("d"), ENTRY("e"), ENTRY("f"), ENTRY("g"),
+        ENTRY("h"), ENTRY("i"), ENTRY("j"), ENTRY("k"), ENTRY("l"), ENTRY("m"), ENTRY("n"),
+        ENTRY("o"), ENTRY("p"), ENTRY("q"), ENTRY("r"), ENTRY("s"), ENTRY("t"), ENTRY("u"),
+        ENTRY("v"), ENTRY("w"), ENTRY("x"), ENTRY("y"), ENTRY("z"),
+    };
+    const mcli::CommandDefinition<Context> reversed[] = {
+        ENTRY("z"), ENTRY("y"), ENTRY("x"), ENTRY("w"), ENTRY("v"), ENTRY("u"), ENTRY("t"),
+        ENTRY("s"), ENTRY("r"), ENTRY("q"), ENTRY("p"), ENTRY("o"), ENTRY("n"), ENTRY("m"),
+        ENTRY("l"), ENTRY("k"), ENTRY("j"), ENTRY("i"), ENTRY("h"), ENTRY("g"), ENTRY("f"),
+        ENTRY("e"), ENTRY("d"), ENTRY("c"), ENTRY("b"), ENTRY("a"),
+    };
+
+    constexpr mcli::CommandDefinition<Context> duplicate[] = {ENTRY("a"), ENTRY("b"), ENTRY("b")};
+    constexpr mcli::CommandDefinition<Context> out_of_order[] = {ENTRY("a"), ENTRY("c"), ENTRY("b")};
+    constexpr mcli::CommandDefinition<Context> shadows_help[] = {ENTRY("a"), ENTRY("help")};
+    constexpr mcli::CommandDefinition<Context> single[] = {ENTRY("only")};
+#undef ENTRY
+
+    constexpr mcli::CommandDefinition<Context> group_with_help[] = {
+        {"a", cmd_name, ""},
+        {"grp", help_child, ""},
+    };
+    constexpr mcli::CommandDefinition<Context> bad_group[] = {
+        {"a", cmd_name, ""},
+        {"grp", unsorted_child, ""},
+    };
+
+    static_assert(mcli::command_table_sorted(alphabet), "sorted table");
+    static_assert(mcli::command_table_sorted(single), "a single entry is sorted");
+    static_assert(!mcli::command_table_sorted(duplicate), "duplicates are rejected");
+    static_assert(!mcli::command_table_sorted(out_of_order), "order is checked");
+    static_assert(!mcli::command_table_sorted(shadows_help), "root entries may not shadow built-ins");
+    static_assert(mcli::command_table_sorted(group_with_help), "groups may have their own help");
+    static_assert(!mcli::command_table_sorted(bad_group), "groups are checked too");
+
+    using Session = test::Session<Context>;
+
+    template<typename Table>
+    void test_lookup(const Table& commands, bool expect_sorted) {
+        Session session(commands);
+        MCLI_CHECK(session.cli.dispatcher().sorted() == expect_sorted);
+        for (char c = 'a'; c <= 'z'; c++) {
+            char name[2] = {c, '\0'};
+            MCLI_CHECK(session.cli.execute_command(name));
+            MCLI_CHECK(strcmp(session.ctx.last, name) == 0);
+        }
+
+        // Before the first, between two and after the last entry
+        const char* missing[] = {"0", "aa", "mz", "{", "zz"};
+        for (const char* name : missing) {
+            session.ctx.last[0] = '\0';
+            MCLI_CHECK(!session.cli.execute_command(name));
+            MCLI_CHECK(session.ctx.last[0] == '\0');
+        }
+    }
+
+    void test_groups_and_fallback() {
+        Session with_help(group_with_help);
+        MCLI_CHECK(with_help.cli.dispatcher().sorted());
+        MCLI_CHECK(with_help.cli.execute_command("grp help"));
+        MCLI_CHECK(strcmp(with_help.ctx.last, "help") == 0);
+
+        // One unsorted group makes the whole tree use the linear scan
+        Session unsorted(bad_group);
+        MCLI_CHECK(!unsorted.cli.dispatcher().sorted());
+        MCLI_CHECK(unsorted.cli.execute_command("grp add"));
+        MCLI_CHECK(strcmp(unsorted.ctx.last, "add") == 0);
+    }
+
+}
+
+int main() {
+    test_lookup(alphabet, true);
+    test_lookup(reversed, false);
+    test_groups_and_fallback();
+    return test::failures() == 0 ? 0 : 1;
+}
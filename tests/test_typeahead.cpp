@@ -0,0 +1,122 @@
+// test_typeahead.cpp
+// Input queued behind a resumable command runs once the command ends
+
+#include "test_main.h"
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        char log[64];
+        size_t log_len;
+    };
+
+    void note(Context* ctx, char c) {
+        if (ctx->log_len + 1 < sizeof(ctx->log)) {
+            ctx->log[ctx->log_len++] = c;
+            ctx->log[ctx->log_len] = '\0';
+        }
+    }
+
+    void cmd_a(const mcli::CommandArgsView&, Context* ctx) { note(ctx, 'a'); }
+    void cmd_b(const mcli::CommandArgsView&, Context* ctx) { note(ctx, 'b'); }
+
+    // Three steps, logged as "s" when it finishes and "x" when cancelled
+    mcli::StepResult cmd_step(const mcli::CommandArgsView&, Context* ctx, mcli::CommandTask& task) {
+        if (task.cancelled) {
+            note(ctx, 'x');
+            return mcli::StepResult::Done;
+        }
+        if (task.step < 2) {
+            return mcli::StepResult::Continue;
+        }
+        note(ctx, 's');
+        return mcli::StepResult::Done;
+    }
+
+    // Never finishes on its own; logs "x" when cancelled
+    mcli::StepResult cmd_dump(const mcli::CommandArgsView&, Context* ctx, mcli::CommandTask& task) {
+        if (task.cancelled) {
+            note(ctx, 'x');
+            return mcli::StepResult::Done;
+        }
+        return mcli::StepResult::Continue;
+    }
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"a", cmd_a, ""},
+        {"b", cmd_b, ""},
+        {"dump", cmd_dump, ""},
+        {"step", cmd_step, ""},
+    };
+
+    using Session = test::Session<Context>;
+
+    void test_queued_behind_step(bool batch) {
+        Session session(commands, batch);
+        session.run("a\rstep\rb\ra\r");
+        MCLI_CHECK(strcmp(session.ctx.log, "asba") == 0);
+        MCLI_CHECK(!session.cli.task_running());
+    }
+
+    void test_typed_while_step_runs(bool batch) {
+        Session session(commands, batch);
+        session.io.set_input("step\r");
+        session.cli.process_input();
+        MCLI_CHECK(session.cli.task_running());
+
+        // Arrives while the command is still running
+        session.run("b\rstep\ra\r");
+        MCLI_CHECK(strcmp(session.ctx.log, "sbsa") == 0);
+    }
+
+    void test_cancel_keeps_later_input() {
+        Session session(commands);
+        session.io.set_input("step\r");
+        session.cli.process_input();
+
+        // "a" was typed for after the command and goes with the cancel; "b" comes after Ctrl-C
+        session.run("a\r\x03" "b\r");
+        MCLI_CHECK(strcmp(session.ctx.log, "xb") == 0);
+        MCLI_CHECK_CONTAINS(session.io.output(), "^C");
+    }
+
+    void test_cancel_after_full_typeahead() {
+        // Far more than the engine holds behind a command, then Ctrl-C
+        char input[300];
+        size_t len = 0;
+        memcpy(input, "dump\r", 5);
+        len += 5;
+        memset(input + len, 'x', 200);
+        len += 200;
+        memcpy(input + len, "\x03" "a\r", 3);
+        len += 3;
+
+        Session session(commands);
+        session.run(input, len);
+        MCLI_CHECK(!session.cli.task_running());
+        MCLI_CHECK(session.io.input_remaining() == 0);
+        MCLI_CHECK(strcmp(session.ctx.log, "xa") == 0);
+    }
+
+    void test_blocking_loop_drains_typeahead() {
+        Session session(commands, true);
+        session.io.set_input("step\ra\rb\r");
+        for (int i = 0; i < 20; i++) {
+            session.cli.process_input_blocking(0);
+        }
+        MCLI_CHECK(strcmp(session.ctx.log, "sab") == 0);
+    }
+
+}
+
+int main() {
+    test_queued_behind_step(false);
+    test_queued_behind_step(true);
+    test_typed_while_step_runs(false);
+    test_typed_while_step_runs(true);
+    test_cancel_keeps_later_input();
+    test_cancel_after_full_typeahead();
+    test_blocking_loop_drains_typeahead();
+    return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// test_typed.cpp
+// Typed argument parsing, range checks and the shared usage error path
+
+#include "test_main.h"
+
+enum class LedMode { Off, On, Blink };
+MCLI_ENUM_ARG(LedMode, "off", "on", "blink")
+
+namespace {
+
+    struct Context {
+        mcli::CliIoInterface* io;
+        int calls;
+        unsigned id;
+        LedMode mode;
+    };
+
+    void set_led(Context* ctx, unsigned id, LedMode mode) {
+        ctx->calls++;
+        ctx->id = id;
+        ctx->mode = mode;
+    }
+
+    // Four parameters: with the command name, every MAX_ARGS slot
+    void set_four(Context* ctx, int, int, int, int) {
+        ctx->calls++;
+    }
+
+    const mcli::CommandDefinition<Context> commands[] = {
+        {"four", MCLI_TYPED(set_four), ""},
+        {"led", MCLI_TYPED(set_led), ""},
+    };
+
+    using Session = test::Session<Context>;
+
+    template<typename T>
+    bool parses(const char* text, T expected) {
+        T value;
+        return mcli::ArgParser<T>::parse(text, value) && value == expected;
+    }
+
+    template<typename T>
+    bool rejects(const char* text) {
+        T value;
+        return !mcli::ArgParser<T>::parse(text, value);
+    }
+
+    void test_integers() {
+        MCLI_CHECK(parses<unsigned char>("255", 255));
+        MCLI_CHECK(rejects<unsigned char>("256"));
+        MCLI_CHECK(parses<signed char>("-128", -128));
+        MCLI_CHECK(rejects<signed char>("-129"));
+        MCLI_CHECK(rejects<signed char>("128"));
+        MCLI_CHECK(parses<int>("0x7fffffff", 0x7fffffff));
+        MCLI_CHECK(parses<int>("-2147483648", -2147483647 - 1));
+        MCLI_CHECK(rejects<int>("2147483648"));
+        MCLI_CHECK(parses<unsigned>("0xFFFFFFFF", 0xFFFFFFFFu));
+        MCLI_CHECK(rejects<unsigned>("-1"));
+        MCLI_CHECK(parses<unsigned long long>("18446744073709551615", 18446744073709551615ull));
+        MCLI_CHECK(rejects<unsigned long long>("18446744073709551616"));
+        MCLI_CHECK(rejects<int>(""));
+        MCLI_CHECK(rejects<int>("0x"));
+        MCLI_CHECK(rejects<int>("12a"));
+        MCLI_CHECK(rejects<unsigned>("0x1g"));
+    }
+
+    void test_other_types() {
+        MCLI_CHECK(parses<double>("-2.5", -2.5));
+        MCLI_CHECK(parses<float>("1e3", 1000.0f));
+        MCLI_CHECK(rejects<double>("1.5x"));
+        MCLI_CHECK(rejects<double>(""));
+        MCLI_CHECK(parses<bool>("on", true));
+        MCLI_CHECK(parses<bool>("no", false));
+        MCLI_CHECK(parses<bool>("1", true));
+        MCLI_CHECK(rejects<bool>("maybe"));
+        MCLI_CHECK(parses<LedMode>("blink", LedMode::Blink));
+        MCLI_CHECK(rejects<LedMode>("Blink"));
+        MCLI_CHECK(strcmp(mcli::ArgParser<LedMode>::name, "off|on|blink") == 0);
+    }
+
+    void test_dispatch() {
+        Session session(commands);
+        session.run("led 2 blink\r");
+        MCLI_CHECK(session.ctx.calls == 1);
+        MCLI_CHECK(session.ctx.id == 2 && session.ctx.mode == LedMode::Blink);
+
+        session.io.clear_output();
+        session.run("led 2 blinky\r");
+        MCLI_CHECK(session.ctx.calls == 1);
+        MCLI_CHECK_CONTAINS(session.io.output(), "Invalid argument 2 \"blinky\": expected off|on|blink\r\n");
+        MCLI_CHECK_CONTAINS(session.io.output(), "Usage: led <uint> <off|on|blink>\r\n");
+
+        session.io.clear_output();
+        session.run("led 2\r");
+        MCLI_CHECK(session.ctx.calls == 1);
+        MCLI_CHECK_CONTAINS(session.io.output(), "Usage: led <uint> <off|on|blink>\r\n");
+    }
+
+    void test_tokens_past_max_args() {
+        Session session(commands);
+        session.run("led 2 on extra junk\r");
+        MCLI_CHECK(session.ctx.calls == 0);
+        MCLI_CHECK_CONTAINS(session.io.output(), "Usage: led <uint> <off|on|blink>\r\n");
+
+        // Exactly MAX_ARGS tokens still run; one more does not
+        session.run("four 1 2 3 4\r");
+        MCLI_CHECK(session.ctx.calls == 1);
+        session.run("four 1 2 3 4 5\r");
+        MCLI_CHECK(session.ctx.calls == 1);
+        MCLI_CHECK(!session.cli.execute_command("four 1 2 3 4 5"));
+        MCLI_CHECK(session.cli.execute_command("four 1 2 3 4   "));
+        MCLI_CHECK(session.ctx.calls == 2);
+    }
+
+    void test_tokenizer_overflow_flag() {
+        char line[] = "a b  c   ";
+        const char* argv[3];
+        size_t lengths[2];
+        bool overflow = true;
+        MCLI_CHECK(mcli::tokenize_in_place(line, argv, lengths, 2, &overflow) == 2);
+        MCLI_CHECK(overflow);
+
+        char exact[] = "a b   ";
+        MCLI_CHECK(mcli::tokenize_in_place(exact, argv, lengths, 2, &overflow) == 2);
+        MCLI_CHECK(!overflow);
+        MCLI_CHECK(strcmp(argv[1], "b") == 0 && lengths[1] == 1);
+    }
+
+}
+
+int main() {
+    test_integers();
+    test_other_types();
+    test_dispatch();
+    test_tokens_past_max_args();
+    test_tokenizer_overflow_flag();
+    return test::failures() == 0 ? 0 : 1;
+}